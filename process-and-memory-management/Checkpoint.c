@@ -0,0 +1,386 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Checkpoint.h"
+
+// Reference to no process
+#define NO_PROCESS -1
+
+void openCheckpoint(Checkpoint *checkpoint, FILE *file, bool saving) {
+    checkpoint->file = file;
+    checkpoint->saving = saving;
+    checkpoint->failed = false;
+    checkpoint->processes = NULL;
+    checkpoint->processCount = 0;
+    checkpoint->processCapacity = 0;
+    checkpoint->slots = NULL;
+    checkpoint->slotCount = 0;
+}
+
+int closeCheckpoint(Checkpoint *checkpoint) {
+    free(checkpoint->processes);
+    free(checkpoint->slots);
+    checkpoint->processes = NULL;
+    checkpoint->slots = NULL;
+    return checkpoint->failed ? -1 : 0;
+}
+
+void checkpointBytes(Checkpoint *checkpoint, void *data, size_t size) {
+    if (checkpoint->failed || size == 0) {
+        return;
+    }
+    size_t done = checkpoint->saving ? fwrite(data, size, 1, checkpoint->file) : fread(data, size, 1, checkpoint->file);
+    if (done != 1) {
+        checkpoint->failed = true;
+    }
+}
+
+void checkpointInt(Checkpoint *checkpoint, int *value) {
+    checkpointBytes(checkpoint, value, sizeof(int));
+}
+
+void checkpointLong(Checkpoint *checkpoint, long *value) {
+    checkpointBytes(checkpoint, value, sizeof(long));
+}
+
+void* checkpointArray(Checkpoint *checkpoint, void *data, size_t size) {
+    int present = data != NULL;
+    checkpointInt(checkpoint, &present);
+    if (checkpoint->saving) {
+        if (present) {
+            checkpointBytes(checkpoint, data, size);
+        }
+        return data;
+    }
+    if (!present || checkpoint->failed) {
+        return NULL;
+    }
+    // Zero sized arrays still exist, a page table of a process without pages
+    void *array = malloc(size > 0 ? size : 1);
+    if (!array) {
+        checkpoint->failed = true;
+        return NULL;
+    }
+    checkpointBytes(checkpoint, array, size);
+    return array;
+}
+
+static size_t slotOf(Checkpoint *checkpoint, const Process *process) {
+    return (size_t)(((uintptr_t)process >> 4) * 2654435761u) & (checkpoint->slotCount - 1);
+}
+
+// Index of process among the processes stored so far, -1 if it was not stored
+static int findProcess(Checkpoint *checkpoint, const Process *process) {
+    if (checkpoint->slotCount == 0) {
+        return -1;
+    }
+    for (size_t slot = slotOf(checkpoint, process);; slot = (slot + 1) & (checkpoint->slotCount - 1)) {
+        int index = checkpoint->slots[slot];
+        if (index < 0 || checkpoint->processes[index] == process) {
+            return index;
+        }
+    }
+}
+
+static void insertSlot(Checkpoint *checkpoint, int index) {
+    size_t slot = slotOf(checkpoint, checkpoint->processes[index]);
+    while (checkpoint->slots[slot] >= 0) {
+        slot = (slot + 1) & (checkpoint->slotCount - 1);
+    }
+    checkpoint->slots[slot] = index;
+}
+
+// Give process the next index. The address hash is only needed when saving
+static int addProcess(Checkpoint *checkpoint, Process *process) {
+    if (checkpoint->processCount == checkpoint->processCapacity) {
+        int capacity = checkpoint->processCapacity ? 2 * checkpoint->processCapacity : 64;
+        Process **grown = (Process **)realloc(checkpoint->processes, capacity * sizeof(Process *));
+        if (!grown) {
+            return -1;
+        }
+        checkpoint->processes = grown;
+        checkpoint->processCapacity = capacity;
+    }
+    if (checkpoint->saving && 2 * (checkpoint->processCount + 1) > checkpoint->slotCount) {
+        int slotCount = checkpoint->slotCount ? 2 * checkpoint->slotCount : 128;
+        int *slots = (int *)malloc(slotCount * sizeof(int));
+        if (!slots) {
+            return -1;
+        }
+        for (int i = 0; i < slotCount; i++) {
+            slots[i] = -1;
+        }
+        free(checkpoint->slots);
+        checkpoint->slots = slots;
+        checkpoint->slotCount = slotCount;
+        for (int i = 0; i < checkpoint->processCount; i++) {
+            insertSlot(checkpoint, i);
+        }
+    }
+    int index = checkpoint->processCount++;
+    checkpoint->processes[index] = process;
+    if (checkpoint->saving) {
+        insertSlot(checkpoint, index);
+    }
+    return index;
+}
+
+// Everything a process owns. When restoring, every pointer it holds is replaced, by
+// NULL once something failed, so the process can always be freed
+static void checkpointProcessRecord(Checkpoint *checkpoint, Process *process) {
+    checkpointBytes(checkpoint, process, sizeof(Process));
+    size_t pages = process->memoryRequirement > 0 ? (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE : 0;
+    process->frameAllocations = checkpointArray(checkpoint, process->frameAllocations, pages * sizeof(int));
+    process->privateCopies = checkpointArray(checkpoint, process->privateCopies, pages * sizeof(bool));
+
+    ReferenceModel *model = checkpointArray(checkpoint, process->referenceModel, sizeof(ReferenceModel));
+    if (model) {
+        model->trace = checkpointArray(checkpoint, model->trace, model->traceLength * sizeof(int));
+    }
+    process->referenceModel = model;
+
+    WorkingSet *workingSet = checkpointArray(checkpoint, process->workingSet, sizeof(WorkingSet));
+    if (workingSet) {
+        workingSet->recent = checkpointArray(checkpoint, workingSet->recent, workingSet->window * sizeof(int));
+        workingSet->lastReference = checkpointArray(checkpoint, workingSet->lastReference, workingSet->pages * sizeof(long));
+    }
+    process->workingSet = workingSet;
+}
+
+Process* checkpointProcess(Checkpoint *checkpoint, Process *process) {
+    int index = process ? findProcess(checkpoint, process) : NO_PROCESS;
+    if (checkpoint->saving && process && index < 0) {
+        // Stored whole right after its index, which is the next one
+        index = checkpoint->processCount;
+        checkpointInt(checkpoint, &index);
+        if (addProcess(checkpoint, process) < 0) {
+            checkpoint->failed = true;
+        }
+        checkpointProcessRecord(checkpoint, process);
+        return process;
+    }
+    checkpointInt(checkpoint, &index);
+    if (checkpoint->saving || checkpoint->failed || index == NO_PROCESS) {
+        return checkpoint->saving ? process : NULL;
+    }
+    if (index >= 0 && index < checkpoint->processCount) {
+        return checkpoint->processes[index];
+    }
+    if (index != checkpoint->processCount) {
+        checkpoint->failed = true;
+        return NULL;
+    }
+    Process *restored = (Process *)malloc(sizeof(Process));
+    if (!restored || addProcess(checkpoint, restored) < 0) {
+        free(restored);
+        checkpoint->failed = true;
+        return NULL;
+    }
+    checkpointProcessRecord(checkpoint, restored);
+    if (checkpoint->failed) {
+        // Nothing holds it yet
+        checkpoint->processCount--;
+        freeProcess(restored);
+        return NULL;
+    }
+    return restored;
+}
+
+Process* checkpointProcessReference(Checkpoint *checkpoint, const Process *process) {
+    // A finished process is never dereferenced, only looked up by address
+    int index = process ? findProcess(checkpoint, process) : NO_PROCESS;
+    checkpointInt(checkpoint, &index);
+    if (checkpoint->saving) {
+        return (Process *)process;
+    }
+    if (checkpoint->failed || index == NO_PROCESS) {
+        return NULL;
+    }
+    if (index < 0 || index >= checkpoint->processCount) {
+        checkpoint->failed = true;
+        return NULL;
+    }
+    return checkpoint->processes[index];
+}
+
+void checkpointQueue(Checkpoint *checkpoint, Queue *queue) {
+    int count = queue->count;
+    checkpointInt(checkpoint, &count);
+    Node *node = queue->front;
+    for (int i = 0; i < count && !checkpoint->failed; i++) {
+        Process *process = checkpointProcess(checkpoint, checkpoint->saving ? node->data : NULL);
+        if (checkpoint->saving) {
+            node = node->next;
+        } else if (process) {
+            enqueue(queue, process);
+        }
+    }
+}
+
+// In-order successor in the fair tree
+static FairNode* nextFairNode(FairNode *node) {
+    if (node->right) {
+        node = node->right;
+        while (node->left) {
+            node = node->left;
+        }
+        return node;
+    }
+    while (node->parent && node == node->parent->right) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+// Processes are stored in tree order and inserted again in that order, which keeps
+// the order of equal vruntimes though their sequence numbers start over
+void checkpointFairQueue(Checkpoint *checkpoint, FairQueue *queue) {
+    int count = queue->count;
+    checkpointInt(checkpoint, &count);
+    FairNode *node = queue->leftmost;
+    for (int i = 0; i < count && !checkpoint->failed; i++) {
+        Process *process = checkpointProcess(checkpoint, checkpoint->saving ? node->data : NULL);
+        if (checkpoint->saving) {
+            node = nextFairNode(node);
+        } else if (process) {
+            fairEnqueue(queue, process);
+        }
+    }
+    checkpointLong(checkpoint, &queue->minVruntime);
+    checkpointBytes(checkpoint, &queue->nextSequence, sizeof(queue->nextSequence));
+}
+
+void checkpointFeedbackQueue(Checkpoint *checkpoint, FeedbackQueue *queue) {
+    for (int i = 0; i < queue->numLevels; i++) {
+        checkpointQueue(checkpoint, queue->levels[i]);
+    }
+    checkpointBytes(checkpoint, &queue->nonEmptyLevels, sizeof(queue->nonEmptyLevels));
+    checkpointInt(checkpoint, &queue->count);
+}
+
+void checkpointTlb(Checkpoint *checkpoint, Tlb *tlb) {
+    tlb->currentOwner = checkpointProcessReference(checkpoint, tlb->currentOwner);
+    for (int i = 0; i < tlb->sets * tlb->ways; i++) {
+        TlbEntry *entry = &tlb->entries[i];
+        entry->owner = checkpointProcessReference(checkpoint, entry->owner);
+        checkpointInt(checkpoint, &entry->page);
+        checkpointBytes(checkpoint, &entry->stamp, sizeof(entry->stamp));
+        checkpointBytes(checkpoint, &entry->valid, sizeof(entry->valid));
+    }
+    checkpointBytes(checkpoint, &tlb->clock, sizeof(tlb->clock));
+    checkpointBytes(checkpoint, &tlb->seed, sizeof(tlb->seed));
+    checkpointLong(checkpoint, &tlb->hits);
+    checkpointLong(checkpoint, &tlb->misses);
+}
+
+// The hole list in address order, rebuilt when restoring, and the hole statistics
+static void checkpointContiguousMemory(Checkpoint *checkpoint, MemoryManager *manager) {
+    int totalMemory = manager->totalMemory;
+    checkpointInt(checkpoint, &totalMemory);
+    if (totalMemory != manager->totalMemory) {
+        checkpoint->failed = true;
+        return;
+    }
+
+    int holes = 0;
+    for (MemoryHole *hole = manager->head; hole; hole = hole->next) {
+        holes++;
+    }
+    checkpointInt(checkpoint, &holes);
+    if (checkpoint->saving) {
+        for (MemoryHole *hole = manager->head; hole; hole = hole->next) {
+            checkpointInt(checkpoint, &hole->start);
+            checkpointInt(checkpoint, &hole->size);
+        }
+    } else {
+        MemoryHole *last = NULL;
+        // A fresh manager holds one hole for all of memory
+        free(manager->head);
+        manager->head = NULL;
+        for (int i = 0; i < holes && !checkpoint->failed; i++) {
+            MemoryHole *hole = (MemoryHole *)malloc(sizeof(MemoryHole));
+            if (!hole) {
+                checkpoint->failed = true;
+                break;
+            }
+            checkpointInt(checkpoint, &hole->start);
+            checkpointInt(checkpoint, &hole->size);
+            hole->prev = last;
+            hole->next = NULL;
+            if (last) {
+                last->next = hole;
+            } else {
+                manager->head = hole;
+            }
+            last = hole;
+        }
+    }
+    checkpointBytes(checkpoint, manager->holeSizes, (manager->totalMemory + 1) * sizeof(int));
+    checkpointInt(checkpoint, &manager->holeCount);
+    checkpointInt(checkpoint, &manager->peakHoleCount);
+    checkpointInt(checkpoint, &manager->freeMemory);
+    checkpointInt(checkpoint, &manager->largestHole);
+}
+
+// Frames and shared segments. The frame table is stored with the memory state, only
+// its pointers are fixed up here
+static void checkpointFrames(Checkpoint *checkpoint, FrameTable *table) {
+    for (int i = 0; i < TOTAL_FRAMES; i++) {
+        table->frames[i].process = checkpointProcessReference(checkpoint, table->frames[i].process);
+    }
+    for (int i = 0; i < table->segmentCount; i++) {
+        SharedSegment *segment = &table->segments[i];
+        segment->frames = checkpointArray(checkpoint, segment->frames, segment->pages * sizeof(int));
+        if (!checkpoint->saving) {
+            segment->mappers = NULL;
+            if (segment->mapperCapacity > 0 && !checkpoint->failed &&
+                !(segment->mappers = (Process **)malloc(segment->mapperCapacity * sizeof(Process *)))) {
+                checkpoint->failed = true;
+            }
+            if (!segment->mappers) {
+                segment->mapperCount = 0;
+                segment->mapperCapacity = 0;
+            }
+        }
+        for (int j = 0; j < segment->mapperCount; j++) {
+            segment->mappers[j] = checkpointProcessReference(checkpoint, segment->mappers[j]);
+        }
+    }
+}
+
+void checkpointMemoryState(Checkpoint *checkpoint, MemoryState *memory) {
+    // The hole list, the resident list and the outputs belong to this run
+    MemoryManager *manager = memory->memoryManager;
+    Process **resident = memory->resident;
+    FILE *output = memory->output;
+    FILE *frameOutput = memory->frameTable.output;
+    checkpointBytes(checkpoint, memory, sizeof(MemoryState));
+    memory->memoryManager = manager;
+    memory->output = output;
+    memory->frameTable.output = frameOutput;
+    if (checkpoint->failed) {
+        // Nothing read can be trusted, leave nothing to free
+        memory->resident = resident;
+        memory->frameTable.segmentCount = 0;
+        return;
+    }
+
+    if (!checkpoint->saving) {
+        memory->resident = NULL;
+        if (memory->residentCount > 0 &&
+            !(memory->resident = (Process **)malloc(memory->residentCount * sizeof(Process *)))) {
+            checkpoint->failed = true;
+            memory->residentCount = 0;
+        }
+        memory->residentCapacity = memory->residentCount;
+    }
+    for (int i = 0; i < memory->residentCount; i++) {
+        memory->resident[i] = checkpointProcessReference(checkpoint, memory->resident[i]);
+    }
+    if (manager) {
+        checkpointContiguousMemory(checkpoint, manager);
+    }
+    if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        checkpointFrames(checkpoint, &memory->frameTable);
+    }
+}
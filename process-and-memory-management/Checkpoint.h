@@ -0,0 +1,54 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "Process.h"
+#include "Queue.h"
+#include "FairQueue.h"
+#include "FeedbackQueue.h"
+#include "Scheduler.h"
+
+// Binary snapshot of simulation state. Every function below either writes the value
+// it is given or, when restoring, reads it back in place, so one function describes
+// both directions of a structure and they cannot drift apart. Plain structures are
+// stored as they are in memory, which ties a checkpoint to the build that wrote it
+typedef struct {
+    FILE *file; // Checkpoint being written or read
+    bool saving; // Writing the state, otherwise reading it back
+    bool failed; // A read or write failed or the data made no sense, the rest is skipped
+    Process **processes; // Processes by index, in the order they were first stored
+    int processCount; // Number of processes stored
+    int processCapacity; // Slots allocated for processes
+    int *slots; // Hash of process addresses to their index, -1 for an empty slot, used when saving
+    int slotCount; // Slots of the hash, a power of two
+} Checkpoint;
+
+void openCheckpoint(Checkpoint *checkpoint, FILE *file, bool saving);
+// Free the lookup tables, not the processes. Return 0 if everything was read or written
+int closeCheckpoint(Checkpoint *checkpoint);
+
+void checkpointBytes(Checkpoint *checkpoint, void *data, size_t size);
+void checkpointInt(Checkpoint *checkpoint, int *value);
+void checkpointLong(Checkpoint *checkpoint, long *value);
+// An array of size bytes that may be NULL. Return data when saving, a new allocation
+// or NULL when restoring
+void* checkpointArray(Checkpoint *checkpoint, void *data, size_t size);
+
+// A process the caller owns, stored whole the first time it is seen
+Process* checkpointProcess(Checkpoint *checkpoint, Process *process);
+// A process that may already have finished and been freed, only stored as a reference
+// to one stored whole. Unknown processes come back as NULL
+Process* checkpointProcessReference(Checkpoint *checkpoint, const Process *process);
+
+// Containers are filled when restoring, they must be empty then
+void checkpointQueue(Checkpoint *checkpoint, Queue *queue);
+void checkpointFairQueue(Checkpoint *checkpoint, FairQueue *queue);
+void checkpointFeedbackQueue(Checkpoint *checkpoint, FeedbackQueue *queue);
+void checkpointTlb(Checkpoint *checkpoint, Tlb *tlb);
+// Memory of the strategy in use, after every process that holds memory was stored
+void checkpointMemoryState(Checkpoint *checkpoint, MemoryState *memory);
+
+#endif
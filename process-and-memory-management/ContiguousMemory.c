@@ -1,6 +1,30 @@
 #include "ContiguousMemory.h"
+#include "Profile.h"
 #include <stdlib.h>
 
+// Keep the hole statistics in step with a hole changing from oldSize to newSize, where 0
+// stands for no hole. The largest hole only moves down past sizes no hole has, so the
+// walk is bounded by the memory size and never touches the hole list
+static void noteHoleSize(MemoryManager *manager, int oldSize, int newSize) {
+    if (oldSize > 0) {
+        manager->holeSizes[oldSize]--;
+        manager->holeCount--;
+    }
+    if (newSize > 0) {
+        manager->holeSizes[newSize]++;
+        manager->holeCount++;
+    }
+    manager->freeMemory += newSize - oldSize;
+    if (newSize > manager->largestHole) {
+        manager->largestHole = newSize;
+    }
+    while (manager->largestHole > 0 && manager->holeSizes[manager->largestHole] == 0) {
+        manager->largestHole--;
+    }
+    if (manager->holeCount > manager->peakHoleCount) {
+        manager->peakHoleCount = manager->holeCount;
+    }
+}
 
 MemoryManager* createContiguousMemory(int totalMemory) {
     MemoryManager *manager = (MemoryManager *)malloc(sizeof(MemoryManager));
@@ -8,7 +32,10 @@ MemoryManager* createContiguousMemory(int totalMemory) {
     
     manager->totalMemory = totalMemory;
     manager->head = (MemoryHole *)malloc(sizeof(MemoryHole));
-    if (!manager->head) {
+    manager->holeSizes = (int *)calloc(totalMemory + 1, sizeof(int));
+    if (!manager->head || !manager->holeSizes) {
+        free(manager->head);
+        free(manager->holeSizes);
         free(manager);
         return NULL;
     }
@@ -17,17 +44,42 @@ MemoryManager* createContiguousMemory(int totalMemory) {
     manager->head->size = totalMemory;
     manager->head->prev = NULL;
     manager->head->next = NULL;
+    manager->holeCount = 0;
+    manager->peakHoleCount = 0;
+    manager->freeMemory = 0;
+    manager->largestHole = 0;
+    noteHoleSize(manager, 0, totalMemory);
     
     return manager;
 }
 
+// External fragmentation, the share of free memory outside the largest hole. 0 means a
+// request as large as all free memory fits, values near 1 that free memory is scattered
+double fragmentationIndex(MemoryManager *manager) {
+    if (manager->freeMemory == 0) return 0.0;
+    return 1.0 - (double)manager->largestHole / manager->freeMemory;
+}
+
+void freeContiguousMemory(MemoryManager *manager) {
+    MemoryHole *current = manager->head;
+    while (current) {
+        MemoryHole *next = current->next;
+        free(current);
+        current = next;
+    }
+    free(manager->holeSizes);
+    free(manager);
+}
+
 int allocateMemory(MemoryManager *manager, int size) {
     MemoryHole *current = manager->head;
     while (current != NULL) {
+        PROFILE_COUNT(COUNT_HOLES_TRAVERSED, 1);
         if (current->size >= size) {
             int allocatedAddress = current->start;
             current->start += size;
             current->size -= size;
+            noteHoleSize(manager, current->size + size, current->size);
             
             if (current->size == 0) {
                 // Remove the hole if it's completely used
@@ -52,6 +104,61 @@ int allocateMemory(MemoryManager *manager, int size) {
     return -1;
 }
 
+// First fit that keeps the block inside [rangeStart, rangeEnd), one memory node. A hole
+// reaching in from below the range is split around the block
+int allocateMemoryInRange(MemoryManager *manager, int size, int rangeStart, int rangeEnd) {
+    for (MemoryHole *current = manager->head; current != NULL; current = current->next) {
+        PROFILE_COUNT(COUNT_HOLES_TRAVERSED, 1);
+        int holeEnd = current->start + current->size;
+        int start = current->start > rangeStart ? current->start : rangeStart;
+        int end = holeEnd < rangeEnd ? holeEnd : rangeEnd;
+        if (end - start < size) {
+            continue;
+        }
+
+        if (start == current->start) {
+            current->start += size;
+            current->size -= size;
+            noteHoleSize(manager, current->size + size, current->size);
+            if (current->size == 0) {
+                // Remove the hole if it's completely used
+                if (current->prev) {
+                    current->prev->next = current->next;
+                }
+                if (current->next) {
+                    current->next->prev = current->prev;
+                }
+                if (current == manager->head) {
+                    manager->head = current->next;
+                }
+                free(current);
+            }
+            return start;
+        }
+
+        // The hole keeps the part below the block, a new hole takes the part above it
+        if (start + size < holeEnd) {
+            MemoryHole *after = (MemoryHole *)malloc(sizeof(MemoryHole));
+            if (!after) {
+                return -1;
+            }
+            after->start = start + size;
+            after->size = holeEnd - after->start;
+            after->prev = current;
+            after->next = current->next;
+            if (current->next) {
+                current->next->prev = after;
+            }
+            current->next = after;
+            noteHoleSize(manager, 0, after->size);
+        }
+        noteHoleSize(manager, current->size, start - current->start);
+        current->size = start - current->start;
+        return start;
+    }
+    return -1;
+}
+
 void deallocateMemory(MemoryManager *manager, int start, int size) {
     MemoryHole *newHole = (MemoryHole *)malloc(sizeof(MemoryHole));
      // Handle allocation failure gracefully.
@@ -61,12 +168,14 @@ void deallocateMemory(MemoryManager *manager, int start, int size) {
     newHole->size = size;
     newHole->prev = NULL;
     newHole->next = NULL;
+    noteHoleSize(manager, 0, size);
 
     if (!manager->head) {
         manager->head = newHole;
     } else {
         MemoryHole *current = manager->head;
         while (current && current->start < start) {
+            PROFILE_COUNT(COUNT_HOLES_TRAVERSED, 1);
             current = current->next;
         }
 
@@ -101,6 +210,8 @@ void mergeHoles(MemoryManager *manager, MemoryHole *startHole) {
     MemoryHole *current = startHole->prev ? startHole->prev : startHole;
     while (current && current->next) {
         if (current->start + current->size == current->next->start) {
+            noteHoleSize(manager, current->size, current->size + current->next->size);
+            noteHoleSize(manager, current->next->size, 0);
             current->size += current->next->size;
             MemoryHole *toDelete = current->next;
             current->next = toDelete->next;
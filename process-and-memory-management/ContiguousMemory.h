@@ -11,11 +11,19 @@ typedef struct MemoryHole {
 typedef struct {
     MemoryHole *head; // Pointing to the head of the memory manager
     int totalMemory; // Total memory of the memory manager
+    int *holeSizes; // Number of holes of each size, so the largest is known without a scan
+    int holeCount; // Number of holes
+    int peakHoleCount; // Most holes at once
+    int freeMemory; // Memory in holes
+    int largestHole; // Size of the largest hole, 0 when memory is full
 } MemoryManager;
 
 MemoryManager* createContiguousMemory(int totalMemory);
 int allocateMemory(MemoryManager *manager, int size);
+int allocateMemoryInRange(MemoryManager *manager, int size, int rangeStart, int rangeEnd);
 void deallocateMemory(MemoryManager *manager, int start, int size);
 void mergeHoles(MemoryManager *manager, MemoryHole *starthole);
+double fragmentationIndex(MemoryManager *manager);
+void freeContiguousMemory(MemoryManager *manager);
 
 #endif 
@@ -0,0 +1,293 @@
+#include <stdlib.h>
+#include "FairQueue.h"
+#include "Profile.h"
+
+// Red-black tree ordered by (vruntime, sequence). The leftmost node is cached
+// so the fair scheduler can pick its next process in O(1) and requeue it in O(log n).
+
+static int nodeBefore(FairNode *a, FairNode *b) {
+    if (a->vruntime != b->vruntime) {
+        return a->vruntime < b->vruntime;
+    }
+    return a->sequence < b->sequence;
+}
+
+static FairColor colorOf(FairNode *node) {
+    // Empty leaves count as black
+    return node ? node->color : FAIR_BLACK;
+}
+
+static void rotateLeft(FairQueue *queue, FairNode *node) {
+    FairNode *pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) {
+        pivot->left->parent = node;
+    }
+    pivot->parent = node->parent;
+    if (!node->parent) {
+        queue->root = pivot;
+    } else if (node == node->parent->left) {
+        node->parent->left = pivot;
+    } else {
+        node->parent->right = pivot;
+    }
+    pivot->left = node;
+    node->parent = pivot;
+}
+
+static void rotateRight(FairQueue *queue, FairNode *node) {
+    FairNode *pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) {
+        pivot->right->parent = node;
+    }
+    pivot->parent = node->parent;
+    if (!node->parent) {
+        queue->root = pivot;
+    } else if (node == node->parent->right) {
+        node->parent->right = pivot;
+    } else {
+        node->parent->left = pivot;
+    }
+    pivot->right = node;
+    node->parent = pivot;
+}
+
+FairQueue* createFairQueue() {
+    FairQueue *queue = (FairQueue *)malloc(sizeof(FairQueue));
+    if (queue == NULL) {
+        // Allocation failed
+        return NULL;
+    }
+    queue->root = NULL;
+    queue->leftmost = NULL;
+    queue->count = 0;
+    queue->minVruntime = 0;
+    queue->nextSequence = 0;
+    return queue;
+}
+
+// Insert a process keyed by its current vruntime
+void fairEnqueue(FairQueue *queue, Process *process) {
+    PROFILE_COUNT(COUNT_QUEUE_OPS, 1);
+    FairNode *node = (FairNode *)malloc(sizeof(FairNode));
+    if (!node) {
+        return;
+    }
+    node->data = process;
+    node->vruntime = process->vruntime;
+    node->sequence = queue->nextSequence++;
+    node->color = FAIR_RED;
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+
+    // Plain binary search tree insertion, remembering whether we only went left
+    FairNode *parent = NULL;
+    FairNode *current = queue->root;
+    int leftmost = 1;
+    while (current) {
+        parent = current;
+        if (nodeBefore(node, current)) {
+            current = current->left;
+        } else {
+            current = current->right;
+            leftmost = 0;
+        }
+    }
+    node->parent = parent;
+    if (!parent) {
+        queue->root = node;
+    } else if (nodeBefore(node, parent)) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+    if (leftmost) {
+        queue->leftmost = node;
+    }
+
+    // Restore the red-black properties
+    while (node != queue->root && colorOf(node->parent) == FAIR_RED) {
+        FairNode *grandparent = node->parent->parent;
+        if (node->parent == grandparent->left) {
+            FairNode *uncle = grandparent->right;
+            if (colorOf(uncle) == FAIR_RED) {
+                node->parent->color = FAIR_BLACK;
+                uncle->color = FAIR_BLACK;
+                grandparent->color = FAIR_RED;
+                node = grandparent;
+            } else {
+                if (node == node->parent->right) {
+                    node = node->parent;
+                    rotateLeft(queue, node);
+                }
+                node->parent->color = FAIR_BLACK;
+                grandparent->color = FAIR_RED;
+                rotateRight(queue, grandparent);
+            }
+        } else {
+            FairNode *uncle = grandparent->left;
+            if (colorOf(uncle) == FAIR_RED) {
+                node->parent->color = FAIR_BLACK;
+                uncle->color = FAIR_BLACK;
+                grandparent->color = FAIR_RED;
+                node = grandparent;
+            } else {
+                if (node == node->parent->left) {
+                    node = node->parent;
+                    rotateRight(queue, node);
+                }
+                node->parent->color = FAIR_BLACK;
+                grandparent->color = FAIR_RED;
+                rotateLeft(queue, grandparent);
+            }
+        }
+    }
+    queue->root->color = FAIR_BLACK;
+    queue->count++;
+}
+
+// Remove the leftmost node. It never has a left child, so it is replaced by its right child.
+Process* fairDequeueMin(FairQueue *queue) {
+    FairNode *node = queue->leftmost;
+    if (!node) {
+        return NULL;
+    }
+    PROFILE_COUNT(COUNT_QUEUE_OPS, 1);
+
+    FairNode *child = node->right;
+    FairNode *parent = node->parent;
+    if (child) {
+        child->parent = parent;
+    }
+    if (!parent) {
+        queue->root = child;
+    } else {
+        parent->left = child;
+    }
+
+    // The next minimum is the leftmost node of the right subtree, or the parent
+    if (child) {
+        FairNode *next = child;
+        while (next->left) {
+            next = next->left;
+        }
+        queue->leftmost = next;
+    } else {
+        queue->leftmost = parent;
+    }
+
+    // Removing a black node leaves a "double black" at child that has to be pushed up
+    if (node->color == FAIR_BLACK) {
+        FairNode *current = child;
+        while (current != queue->root && colorOf(current) == FAIR_BLACK) {
+            if (current == parent->left) {
+                FairNode *sibling = parent->right;
+                if (colorOf(sibling) == FAIR_RED) {
+                    sibling->color = FAIR_BLACK;
+                    parent->color = FAIR_RED;
+                    rotateLeft(queue, parent);
+                    sibling = parent->right;
+                }
+                if (colorOf(sibling->left) == FAIR_BLACK && colorOf(sibling->right) == FAIR_BLACK) {
+                    sibling->color = FAIR_RED;
+                    current = parent;
+                    parent = current->parent;
+                } else {
+                    if (colorOf(sibling->right) == FAIR_BLACK) {
+                        sibling->left->color = FAIR_BLACK;
+                        sibling->color = FAIR_RED;
+                        rotateRight(queue, sibling);
+                        sibling = parent->right;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = FAIR_BLACK;
+                    if (sibling->right) {
+                        sibling->right->color = FAIR_BLACK;
+                    }
+                    rotateLeft(queue, parent);
+                    current = queue->root;
+                }
+            } else {
+                FairNode *sibling = parent->left;
+                if (colorOf(sibling) == FAIR_RED) {
+                    sibling->color = FAIR_BLACK;
+                    parent->color = FAIR_RED;
+                    rotateRight(queue, parent);
+                    sibling = parent->left;
+                }
+                if (colorOf(sibling->left) == FAIR_BLACK && colorOf(sibling->right) == FAIR_BLACK) {
+                    sibling->color = FAIR_RED;
+                    current = parent;
+                    parent = current->parent;
+                } else {
+                    if (colorOf(sibling->left) == FAIR_BLACK) {
+                        sibling->right->color = FAIR_BLACK;
+                        sibling->color = FAIR_RED;
+                        rotateLeft(queue, sibling);
+                        sibling = parent->left;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = FAIR_BLACK;
+                    if (sibling->left) {
+                        sibling->left->color = FAIR_BLACK;
+                    }
+                    rotateRight(queue, parent);
+                    current = queue->root;
+                }
+            }
+        }
+        if (current) {
+            current->color = FAIR_BLACK;
+        }
+    }
+
+    Process *process = node->data;
+    if (node->vruntime > queue->minVruntime) {
+        queue->minVruntime = node->vruntime;
+    }
+    free(node);
+    queue->count--;
+    return process;
+}
+
+Process* fairPeek(FairQueue *queue) {
+    return queue->leftmost ? queue->leftmost->data : NULL;
+}
+
+int isFairQueueEmpty(FairQueue *queue) {
+    return queue->root == NULL;
+}
+
+// Newly arrived or re-admitted processes start at the queue's floor so they
+// cannot monopolise the CPU by carrying a stale, small vruntime
+void placeProcess(FairQueue *queue, Process *process) {
+    if (process->vruntime < queue->minVruntime) {
+        process->vruntime = queue->minVruntime;
+    }
+}
+
+// Split the target latency between the running process and everything runnable,
+// but never go below the minimum granularity
+int fairTimeslice(FairQueue *queue, int minGranularity) {
+    int runnable = queue->count + 1;
+    int timeslice = (FAIR_LATENCY_FACTOR * minGranularity) / runnable;
+    return timeslice < minGranularity ? minGranularity : timeslice;
+}
+
+static void freeFairNodes(FairNode *node) {
+    if (!node) {
+        return;
+    }
+    freeFairNodes(node->left);
+    freeFairNodes(node->right);
+    freeProcess(node->data);
+    free(node);
+}
+
+// Free the tree together with the processes it still holds
+void freeFairQueue(FairQueue *queue) {
+    freeFairNodes(queue->root);
+    free(queue);
+}
@@ -0,0 +1,41 @@
+#ifndef FAIR_QUEUE_H
+#define FAIR_QUEUE_H
+
+#include "Process.h"
+
+// Target scheduling latency expressed in minimum-granularity units (the -q quantum)
+#define FAIR_LATENCY_FACTOR 8
+
+typedef enum {
+    FAIR_RED,
+    FAIR_BLACK
+} FairColor;
+
+typedef struct FairNode {
+    Process *data; // Process held by the node
+    long vruntime; // Virtual runtime the node is ordered by
+    unsigned long sequence; // Insertion order, breaks vruntime ties in FIFO order
+    FairColor color; // Red-black colour of the node
+    struct FairNode *left; // Pointing to the left child
+    struct FairNode *right; // Pointing to the right child
+    struct FairNode *parent; // Pointing to the parent node
+} FairNode;
+
+typedef struct {
+    FairNode *root; // Pointing to the root of the tree
+    FairNode *leftmost; // Cached minimum-vruntime node so picks do not walk the tree
+    int count; // Number of processes in the tree
+    long minVruntime; // Monotonic floor used to place newly arrived processes
+    unsigned long nextSequence; // Sequence number handed to the next insertion
+} FairQueue;
+
+FairQueue* createFairQueue();
+void fairEnqueue(FairQueue *queue, Process *process);
+Process* fairDequeueMin(FairQueue *queue);
+Process* fairPeek(FairQueue *queue);
+int isFairQueueEmpty(FairQueue *queue);
+void placeProcess(FairQueue *queue, Process *process);
+int fairTimeslice(FairQueue *queue, int minGranularity);
+void freeFairQueue(FairQueue *queue);
+
+#endif
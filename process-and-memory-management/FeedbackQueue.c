@@ -0,0 +1,76 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "FeedbackQueue.h"
+
+// Multi-level feedback queue. Each level is a plain FIFO and a bitmask of the
+// non-empty levels lets the highest-priority process be found with one find-first-set.
+
+FeedbackQueue* createFeedbackQueue(int numLevels, int baseQuantum) {
+    if (numLevels < 1 || numLevels > FEEDBACK_MAX_LEVELS) {
+        return NULL;
+    }
+
+    FeedbackQueue *queue = (FeedbackQueue *)malloc(sizeof(FeedbackQueue));
+    if (queue == NULL) {
+        // Allocation failed
+        return NULL;
+    }
+    queue->numLevels = numLevels;
+    queue->nonEmptyLevels = 0;
+    queue->count = 0;
+    for (int i = 0; i < numLevels; i++) {
+        queue->levels[i] = createQueue();
+        // Lower levels get longer quanta, doubling each step up to INT_MAX
+        int shift = i < 16 ? i : 16;
+        queue->quantums[i] = baseQuantum > (INT_MAX >> shift) ? INT_MAX : baseQuantum << shift;
+    }
+    return queue;
+}
+
+void feedbackEnqueue(FeedbackQueue *queue, Process *process, int level) {
+    if (level >= queue->numLevels) {
+        level = queue->numLevels - 1;
+    }
+    process->priority = level;
+    enqueue(queue->levels[level], process);
+    queue->nonEmptyLevels |= 1u << level;
+    queue->count++;
+}
+
+// Dequeue from the highest-priority non-empty level and report which level it was
+Process* feedbackDequeue(FeedbackQueue *queue, int *level) {
+    if (queue->nonEmptyLevels == 0) {
+        return NULL;
+    }
+    int highest = __builtin_ctz(queue->nonEmptyLevels);
+    Process *process = dequeue(queue->levels[highest]);
+    if (isQueueEmpty(queue->levels[highest])) {
+        queue->nonEmptyLevels &= ~(1u << highest);
+    }
+    queue->count--;
+    process->priority = highest;
+    if (level) {
+        *level = highest;
+    }
+    return process;
+}
+
+// Move every process back to the top level, keeping their relative order
+void feedbackBoost(FeedbackQueue *queue) {
+    for (int i = 1; i < queue->numLevels; i++) {
+        appendQueue(queue->levels[0], queue->levels[i]);
+    }
+    queue->nonEmptyLevels = isQueueEmpty(queue->levels[0]) ? 0 : 1u;
+}
+
+int isFeedbackQueueEmpty(FeedbackQueue *queue) {
+    return queue->nonEmptyLevels == 0;
+}
+
+// Free every level together with the processes it still holds
+void freeFeedbackQueue(FeedbackQueue *queue) {
+    for (int i = 0; i < queue->numLevels; i++) {
+        freeQueue(queue->levels[i]);
+    }
+    free(queue);
+}
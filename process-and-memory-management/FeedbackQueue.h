@@ -0,0 +1,27 @@
+#ifndef FEEDBACK_QUEUE_H
+#define FEEDBACK_QUEUE_H
+
+#include "Queue.h"
+
+// One bit per level in the non-empty mask
+#define FEEDBACK_MAX_LEVELS 32
+#define FEEDBACK_DEFAULT_LEVELS 3
+// Default boost period expressed in base quanta
+#define FEEDBACK_DEFAULT_BOOST_QUANTA 20
+
+typedef struct {
+    Queue *levels[FEEDBACK_MAX_LEVELS]; // FIFO per priority level, 0 is the highest
+    int quantums[FEEDBACK_MAX_LEVELS]; // Quantum given to a process picked from each level
+    int numLevels; // Number of levels in use
+    unsigned int nonEmptyLevels; // Bit i is set while level i holds a process
+    int count; // Number of processes over all levels
+} FeedbackQueue;
+
+FeedbackQueue* createFeedbackQueue(int numLevels, int baseQuantum);
+void feedbackEnqueue(FeedbackQueue *queue, Process *process, int level);
+Process* feedbackDequeue(FeedbackQueue *queue, int *level);
+void feedbackBoost(FeedbackQueue *queue);
+int isFeedbackQueueEmpty(FeedbackQueue *queue);
+void freeFeedbackQueue(FeedbackQueue *queue);
+
+#endif
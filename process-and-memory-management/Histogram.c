@@ -0,0 +1,51 @@
+#include "Histogram.h"
+
+static int bucketIndex(unsigned int value) {
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+    // Keep the top HISTOGRAM_SUB_BUCKET_BITS + 1 bits, the rest picks the power of two
+    int shift = 31 - __builtin_clz(value) - HISTOGRAM_SUB_BUCKET_BITS;
+    return shift * HISTOGRAM_SUB_BUCKETS + (int)(value >> shift);
+}
+
+// Largest value that lands in bucket index
+static long bucketTop(int index) {
+    if (index < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    long subBucket = index - shift * HISTOGRAM_SUB_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void recordValue(Histogram *histogram, int value) {
+    if (value < 0) {
+        value = 0;
+    }
+    histogram->counts[bucketIndex((unsigned int)value)]++;
+    histogram->count++;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+int histogramPercentile(const Histogram *histogram, double percent) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    // Rank of the value wanted, at least the first one
+    long rank = (long)(percent / 100.0 * histogram->count + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            long top = bucketTop(i);
+            return top < histogram->max ? (int)top : histogram->max;
+        }
+    }
+    return histogram->max;
+}
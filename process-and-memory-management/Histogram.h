@@ -0,0 +1,26 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// Log-bucketed histogram in the style of HdrHistogram. Values below twice the sub-bucket
+// count are exact, larger ones land in one of HISTOGRAM_SUB_BUCKETS buckets per power of
+// two, so every value is off by less than 1 / HISTOGRAM_SUB_BUCKETS. Memory is fixed and
+// recording is O(1)
+
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+// Exact buckets, then one group of sub-buckets per further power of two up to INT_MAX
+#define HISTOGRAM_BUCKETS ((32 - HISTOGRAM_SUB_BUCKET_BITS) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+    int counts[HISTOGRAM_BUCKETS]; // Values recorded in each bucket
+    long count; // Values recorded
+    int max; // Largest value recorded
+} Histogram;
+
+// Record a value, negative values count as 0
+void recordValue(Histogram *histogram, int value);
+// Smallest bucket bound at or above percent of the values, capped at the largest value.
+// Return 0 when nothing was recorded
+int histogramPercentile(const Histogram *histogram, double percent);
+
+#endif
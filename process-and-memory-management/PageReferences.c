@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PageReferences.h"
+
+// Trace files are whitespace separated page numbers
+static ReferenceModel* readTrace(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return NULL;
+    }
+
+    ReferenceModel *model = (ReferenceModel *)calloc(1, sizeof(ReferenceModel));
+    int capacity = 1024;
+    if (model) {
+        model->kind = REFERENCE_TRACE;
+        model->trace = (int *)malloc(capacity * sizeof(int));
+    }
+    if (!model || !model->trace) {
+        free(model);
+        fclose(file);
+        return NULL;
+    }
+
+    int page;
+    while (fscanf(file, "%d", &page) == 1) {
+        if (page < 0) {
+            continue;
+        }
+        if (model->traceLength == capacity) {
+            int *grown = (int *)realloc(model->trace, 2 * capacity * sizeof(int));
+            if (!grown) {
+                break;
+            }
+            model->trace = grown;
+            capacity *= 2;
+        }
+        model->trace[model->traceLength++] = page;
+    }
+    fclose(file);
+
+    if (model->traceLength == 0) {
+        freeReferenceModel(model);
+        return NULL;
+    }
+    return model;
+}
+
+// Parse the optional fifth input column: trace:<path> or locality:<working set>:<phase length>.
+// Return NULL if the spec is malformed or the trace cannot be read
+ReferenceModel* parseReferenceModel(const char *spec) {
+    if (strncmp(spec, "trace:", 6) == 0) {
+        return readTrace(spec + 6);
+    }
+
+    int workingSetSize, phaseLength;
+    char extra;
+    if (sscanf(spec, "locality:%d:%d%c", &workingSetSize, &phaseLength, &extra) != 2 ||
+        workingSetSize < 1 || phaseLength < 1) {
+        return NULL;
+    }
+    ReferenceModel *model = (ReferenceModel *)calloc(1, sizeof(ReferenceModel));
+    if (model) {
+        model->kind = REFERENCE_LOCALITY;
+        model->workingSetSize = workingSetSize;
+        model->phaseLength = phaseLength;
+    }
+    return model;
+}
+
+ReferenceModel* copyReferenceModel(const ReferenceModel *model) {
+    ReferenceModel *copy = (ReferenceModel *)malloc(sizeof(ReferenceModel));
+    if (!copy) {
+        return NULL;
+    }
+    *copy = *model;
+    if (model->trace) {
+        copy->trace = (int *)malloc(model->traceLength * sizeof(int));
+        if (!copy->trace) {
+            free(copy);
+            return NULL;
+        }
+        memcpy(copy->trace, model->trace, model->traceLength * sizeof(int));
+    }
+    return copy;
+}
+
+void freeReferenceModel(ReferenceModel *model) {
+    if (model) {
+        free(model->trace);
+        free(model);
+    }
+}
+
+// Integer hash, so the locality pattern depends only on the position and needs no state
+static unsigned int mix(unsigned long long value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return (unsigned int)value;
+}
+
+// Page touched by reference number position of a process with pages pages. Without a
+// model the process walks its pages in order
+int nextPageReference(const ReferenceModel *model, long position, int pages) {
+    if (!model) {
+        return (int)(position % pages);
+    }
+    if (model->kind == REFERENCE_TRACE) {
+        return model->trace[position % model->traceLength] % pages;
+    }
+    unsigned int base = mix((unsigned long long)(position / model->phaseLength) * 2 + 1);
+    unsigned int offset = mix((unsigned long long)position * 2) % model->workingSetSize;
+    return (int)((base + offset) % pages);
+}
+
+// Whether reference number position writes its page, for writePercent percent of references
+int isWriteReference(long position, int writePercent) {
+    return (int)(mix((unsigned long long)position ^ 0x9e3779b97f4a7c15ULL) % 100) < writePercent;
+}
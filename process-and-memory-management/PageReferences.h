@@ -0,0 +1,24 @@
+#ifndef PAGE_REFERENCES_H
+#define PAGE_REFERENCES_H
+
+// How a process picks the pages it touches
+typedef enum {
+    REFERENCE_TRACE,    // Replay page numbers read from a trace file
+    REFERENCE_LOCALITY  // Random pages within a working set that moves every phase
+} ReferenceKind;
+
+typedef struct {
+    ReferenceKind kind; // Which pattern this is
+    int *trace; // Page numbers of a trace, replayed from the start when exhausted
+    int traceLength; // Number of page numbers in the trace
+    int workingSetSize; // Pages touched during one locality phase
+    int phaseLength; // References before the working set moves
+} ReferenceModel;
+
+ReferenceModel* parseReferenceModel(const char *spec);
+ReferenceModel* copyReferenceModel(const ReferenceModel *model);
+void freeReferenceModel(ReferenceModel *model);
+int nextPageReference(const ReferenceModel *model, long position, int pages);
+int isWriteReference(long position, int writePercent);
+
+#endif
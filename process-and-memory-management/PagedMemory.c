@@ -1,30 +1,467 @@
 #include "PagedMemory.h"
+#include "Profile.h"
 
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-// Assume Frame is defined in PagedMemory.h
-Frame frames[TOTAL_FRAMES];  
-
-void initializeFrames() {
+void initializeFrames(FrameTable *table, FILE *output) {
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        frames[i].frame_number = i;
-        frames[i].process = NULL;
-        frames[i].page_number = -1;
+        table->frames[i].frame_number = i;
+        table->frames[i].process = NULL;
+        table->frames[i].page_number = -1;
+        table->frames[i].huge = false;
+        table->frames[i].lastReference = 0;
+        table->frames[i].segment = -1;
+        table->frames[i].sharers = 0;
+    }
+    table->output = output;
+    table->framesSwappedOut = 0;
+    table->hugeFrames = 0;
+    table->pagesMapped = 0;
+    table->hugePagesMapped = 0;
+    table->hugeWasteFrames = 0;
+    table->hugeFallbacks = 0;
+    table->hugeSplits = 0;
+    table->referenceClock = 0;
+    table->segmentCount = 0;
+    table->sharedPagesMapped = 0;
+    table->sharedFramesReused = 0;
+    table->cowCopies = 0;
+    table->extraMappings = 0;
+    table->peakFramesUsed = 0;
+    table->peakPagesMapped = 0;
+    table->numaNodes = 1;
+    table->preferredNode = 0;
+    table->interleave = false;
+    table->pagesMigrated = 0;
+    table->framesUsed = 0;
+    table->pageFaults = 0;
+    for (int i = 0; i < MAX_NUMA_NODES; i++) {
+        table->nodePeakFrames[i] = 0;
+        table->nodeFrames[i] = 0;
+    }
+    for (int i = 0; i < MAX_MEMORY_GROUPS; i++) {
+        table->groups[i].used = false;
+        table->groups[i].frames = 0;
+        table->groups[i].limitFrames = 0;
+        table->groups[i].peakFrames = 0;
+        table->groups[i].framesEvicted = 0;
+        table->groups[i].reclaims = 0;
+    }
+}
+
+void freeFrameTable(FrameTable *table) {
+    for (int i = 0; i < table->segmentCount; i++) {
+        free(table->segments[i].frames);
+        free(table->segments[i].mappers);
+    }
+    table->segmentCount = 0;
+}
+
+// Node frame belongs to, the frames are split evenly and in order
+int frameNode(FrameTable *table, int frame) {
+    return frame * table->numaNodes / TOTAL_FRAMES;
+}
+
+static int nodeStart(FrameTable *table, int node) {
+    return (node * TOTAL_FRAMES + table->numaNodes - 1) / table->numaNodes;
+}
+
+// Hands out free frames in the order NUMA placement prefers: from the preferred node
+// onwards, or one node after another with interleave. Without NUMA it scans from frame 0
+typedef struct {
+    FrameTable *table;
+    int start; // Frame the scan starts from
+    int scanned; // Frames the scan has looked at
+    int cursor[MAX_NUMA_NODES]; // Next frame to look at in each node under interleave
+    int turn; // Node whose turn it is under interleave
+} FramePicker;
+
+// firstPage is the page the first frame is for, interleave places page p on node p mod nodes
+static void initFramePicker(FramePicker *picker, FrameTable *table, int firstPage) {
+    picker->table = table;
+    picker->start = table->numaNodes > 1 ? nodeStart(table, table->preferredNode) : 0;
+    picker->scanned = 0;
+    for (int node = 0; node < table->numaNodes; node++) picker->cursor[node] = nodeStart(table, node);
+    picker->turn = firstPage % table->numaNodes;
+}
+
+static int pickFreeFrame(FramePicker *picker) {
+    FrameTable *table = picker->table;
+    if (!table->interleave || table->numaNodes <= 1) {
+        while (picker->scanned < TOTAL_FRAMES) {
+            int i = (picker->start + picker->scanned++) % TOTAL_FRAMES;
+            PROFILE_COUNT(COUNT_FRAMES_SCANNED, 1);
+            if (table->frames[i].process == NULL) return i;
+        }
+        return -1;
+    }
+    // A full node passes its turn on
+    for (int tried = 0; tried < table->numaNodes; tried++) {
+        int node = picker->turn;
+        picker->turn = (picker->turn + 1) % table->numaNodes;
+        int end = nodeStart(table, node + 1);
+        while (picker->cursor[node] < end) {
+            int i = picker->cursor[node]++;
+            PROFILE_COUNT(COUNT_FRAMES_SCANNED, 1);
+            if (table->frames[i].process == NULL) return i;
+        }
+    }
+    return -1;
+}
+
+static int firstFreeFrame(FrameTable *table, int page) {
+    FramePicker picker;
+    initFramePicker(&picker, table, page);
+    return pickFreeFrame(&picker);
+}
+
+// Keep the frame counts in step with frame_index being taken (sign 1) or freed (sign -1)
+// by process
+static void chargeFrame(FrameTable *table, int frame_index, Process *process, int sign) {
+    table->framesUsed += sign;
+    table->nodeFrames[frameNode(table, frame_index)] += sign;
+    if (process->memoryGroup >= 0) table->groups[process->memoryGroup].frames += sign;
+}
+
+static bool isGroupFree(FrameTable *table, int first) {
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, table->hugeFrames);
+    for (int i = first; i < first + table->hugeFrames; i++) {
+        if (table->frames[i].process != NULL) return false;
+    }
+    return true;
+}
+
+// Slot of the shared segment with id, added or grown to pages on first use. Return -1
+// when the table has no slot left
+static int findSegment(FrameTable *table, int id, int pages) {
+    int slot = 0;
+    while (slot < table->segmentCount && table->segments[slot].id != id) slot++;
+    if (slot == MAX_SHARED_SEGMENTS) return -1;
+
+    SharedSegment *segment = &table->segments[slot];
+    if (slot == table->segmentCount) {
+        segment->id = id;
+        segment->pages = 0;
+        segment->frames = NULL;
+        segment->mappers = NULL;
+        segment->mapperCount = 0;
+        segment->mapperCapacity = 0;
+        table->segmentCount++;
+    }
+    if (pages > segment->pages) {
+        int *grown = realloc(segment->frames, pages * sizeof(int));
+        if (!grown) return -1;
+        for (int i = segment->pages; i < pages; i++) grown[i] = -1;
+        segment->frames = grown;
+        segment->pages = pages;
     }
+    return slot;
 }
 
-int calculateMemoryUsage() {
-    int occupiedFrames = 0;
+// Number of leading pages, out of pages, that process maps from its shared segment.
+// slot is set to the segment slot, -1 when every page is private
+static int sharedPrefix(FrameTable *table, Process *process, int pages, int *slot) {
+    *slot = -1;
+    if (process->sharedSegment < 0 || process->sharedPages <= 0) return 0;
+    int prefix = process->sharedPages < pages ? process->sharedPages : pages;
+    *slot = findSegment(table, process->sharedSegment, prefix);
+    return *slot == -1 ? 0 : prefix;
+}
+
+static bool isPrivateCopy(Process *process, int page) {
+    return process->privateCopies && process->privateCopies[page];
+}
 
-    // Iterate through all frames and count those that are occupied
+static void addMapper(SharedSegment *segment, Process *process) {
+    for (int i = 0; i < segment->mapperCount; i++) {
+        if (segment->mappers[i] == process) return;
+    }
+    if (segment->mapperCount == segment->mapperCapacity) {
+        int capacity = segment->mapperCapacity ? 2 * segment->mapperCapacity : 8;
+        Process **grown = realloc(segment->mappers, capacity * sizeof(Process *));
+        if (!grown) return;
+        segment->mappers = grown;
+        segment->mapperCapacity = capacity;
+    }
+    segment->mappers[segment->mapperCount++] = process;
+}
+
+static void removeMapper(FrameTable *table, Process *process) {
+    for (int slot = 0; slot < table->segmentCount; slot++) {
+        SharedSegment *segment = &table->segments[slot];
+        if (segment->id != process->sharedSegment) continue;
+        for (int i = 0; i < segment->mapperCount; i++) {
+            if (segment->mappers[i] == process) {
+                segment->mappers[i] = segment->mappers[--segment->mapperCount];
+                break;
+            }
+        }
+    }
+}
+
+// Another process whose page table maps frame_index as page
+static Process *otherMapper(SharedSegment *segment, Process *process, int frame_index, int page) {
+    for (int i = 0; i < segment->mapperCount; i++) {
+        Process *mapper = segment->mappers[i];
+        int pages = (mapper->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+        if (mapper != process && mapper->frameAllocations && page < pages &&
+            mapper->frameAllocations[page] == frame_index) {
+            return mapper;
+        }
+    }
+    return NULL;
+}
+
+// Drop the mapping process holds on frame. A private frame, or a shared frame losing its
+// last mapping, is freed, and with writeBack its page counts as swapped out. A shared frame
+// other page tables still map stays resident and passes to one of them.
+// Return true if the frame was freed
+static bool releaseFrame(FrameTable *table, Frame *frame, Process *process, bool writeBack) {
+    if (frame->segment >= 0 && frame->sharers > 1) {
+        frame->sharers--;
+        table->extraMappings--;
+        if (frame->process == process) {
+            Process *owner = otherMapper(&table->segments[frame->segment], process, frame->frame_number, frame->page_number);
+            if (owner && owner->memoryGroup != process->memoryGroup) {
+                chargeFrame(table, frame->frame_number, process, -1);
+                chargeFrame(table, frame->frame_number, owner, 1);
+            }
+            frame->process = owner;
+        }
+        return false;
+    }
+    if (frame->segment >= 0) {
+        table->segments[frame->segment].frames[frame->page_number] = -1;
+        frame->segment = -1;
+        frame->sharers = 0;
+    }
+    if (writeBack && frame->page_number >= 0) {
+        process->swappedPages++;
+        table->framesSwappedOut++;
+        PROFILE_COUNT(COUNT_EVICTIONS, 1);
+        if (process->memoryGroup >= 0) table->groups[process->memoryGroup].framesEvicted++;
+    }
+    if (frame->process) chargeFrame(table, frame->frame_number, frame->process, -1);
+    frame->process = NULL;
+    frame->page_number = -1;
+    frame->huge = false;
+    return true;
+}
+
+// Drop the mappings process holds on shared frames owned by another process. The frames
+// it owns itself are released with the rest of its frames
+static void releaseSharedMappings(FrameTable *table, Process *process) {
+    if (!process->frameAllocations) return;
+    int slot;
+    int prefix = sharedPrefix(table, process, (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE, &slot);
+    for (int page = 0; page < prefix; page++) {
+        int frame_index = process->frameAllocations[page];
+        if (frame_index == -1) continue;
+        Frame *frame = &table->frames[frame_index];
+        if (frame->segment >= 0 && frame->process != process && frame->sharers > 1) {
+            frame->sharers--;
+            table->extraMappings--;
+            process->frameAllocations[page] = -1;
+            process->numFramesAllocated--;
+        }
+    }
+}
+
+// Map page of process onto frame_index. A shared page (slot >= 0) whose segment page
+// is resident maps that frame instead and frame_index is ignored
+static void mapPage(FrameTable *table, Process *process, int page, int frame_index, int slot) {
+    if (slot >= 0) {
+        SharedSegment *segment = &table->segments[slot];
+        if (segment->frames[page] != -1) {
+            frame_index = segment->frames[page];
+            table->frames[frame_index].sharers++;
+            table->extraMappings++;
+            table->sharedFramesReused++;
+        } else {
+            table->frames[frame_index].segment = slot;
+            table->frames[frame_index].sharers = 1;
+            segment->frames[page] = frame_index;
+        }
+        table->sharedPagesMapped++;
+        addMapper(segment, process);
+    }
+    Frame *frame = &table->frames[frame_index];
+    if (frame->sharers <= 1) {
+        if (!frame->process) chargeFrame(table, frame_index, process, 1);
+        frame->process = process;
+        frame->page_number = page;
+    }
+    frame->lastReference = table->referenceClock;
+    process->frameAllocations[page] = frame_index;
+}
+
+// Map the first prefix pages of process that are not mapped yet. Shared pages reuse their
+// resident frame, the others take free frames. Return the number of pages mapped, which
+// falls short when no frame is free
+static int mapSharedPrefix(FrameTable *table, Process *process, int prefix, int slot) {
+    int mapped = 0;
+    for (int page = 0; page < prefix; page++) {
+        if (process->frameAllocations[page] != -1) continue;
+        int page_slot = isPrivateCopy(process, page) ? -1 : slot;
+        int frame_index = -1;
+        if (page_slot == -1 || table->segments[slot].frames[page] == -1) {
+            frame_index = firstFreeFrame(table, page);
+            if (frame_index == -1) break;
+        }
+        mapPage(table, process, page, frame_index, page_slot);
+        mapped++;
+    }
+    return mapped;
+}
+
+// Shared pages of process among the first prefix that are already resident
+static int residentSharedPages(FrameTable *table, Process *process, int prefix, int slot) {
+    int resident = 0;
+    for (int page = 0; page < prefix; page++) {
+        if (!isPrivateCopy(process, page) && table->segments[slot].frames[page] != -1) resident++;
+    }
+    return resident;
+}
+
+// Track the peak physical footprint, per memory group and node too, and the peak of what
+// private frames would have needed
+static void noteFootprint(FrameTable *table) {
+    int used = table->framesUsed;
+    for (int i = 0; i < MAX_MEMORY_GROUPS; i++) {
+        if (table->groups[i].frames > table->groups[i].peakFrames) table->groups[i].peakFrames = table->groups[i].frames;
+    }
+    for (int i = 0; i < table->numaNodes; i++) {
+        if (table->nodeFrames[i] > table->nodePeakFrames[i]) table->nodePeakFrames[i] = table->nodeFrames[i];
+    }
+    if (used > table->peakFramesUsed) table->peakFramesUsed = used;
+    if (used + table->extraMappings > table->peakPagesMapped) table->peakPagesMapped = used + table->extraMappings;
+}
+
+static bool evictWholeProcess(FrameTable *table, Process *victim, int *evictedFrames);
+static void evictFramesOf(FrameTable *table, Process *least_recently_used, int neededFrames, int *evictedFrames);
+static Process *leastRecentlyUsed(FrameTable *table, Process *currentProcess, int group);
+
+// Frames held by processes of group
+static int groupFrames(FrameTable *table, int group) {
+    return table->groups[group].frames;
+}
+
+// Memory group of process with the limit it gives applied, NULL outside any group
+static MemoryGroup *groupOf(FrameTable *table, Process *process) {
+    if (process->memoryGroup < 0) return NULL;
+    MemoryGroup *group = &table->groups[process->memoryGroup];
+    int limit = process->groupLimit / PAGE_SIZE > 0 ? process->groupLimit / PAGE_SIZE : 1;
+    if (process->groupLimit > 0 && (group->limitFrames == 0 || limit < group->limitFrames)) group->limitFrames = limit;
+    group->used = true;
+    return group;
+}
+
+// Frames process may still take within the limit of its group, INT_MAX without a limit
+static int groupRoom(FrameTable *table, Process *process) {
+    MemoryGroup *group = groupOf(table, process);
+    if (!group || group->limitFrames == 0) return INT_MAX;
+    int used = groupFrames(table, process->memoryGroup);
+    return group->limitFrames > used ? group->limitFrames - used : 0;
+}
+
+// Before process takes needed more frames beyond the limit of its group, evict from the
+// group's own least recently used processes, whole ones unless partial, until it has
+// room or nothing of the group can go
+static void reclaimGroup(FrameTable *table, Process *process, int needed, bool partial, int *evictedFrames) {
+    int room = groupRoom(table, process);
+    if (room >= needed) return;
+    PROFILE_BEGIN(PHASE_EVICTION);
+    table->groups[process->memoryGroup].reclaims++;
+    while (room < needed) {
+        Process *victim = leastRecentlyUsed(table, process, process->memoryGroup);
+        if (!victim) break;
+        if (partial) {
+            evictFramesOf(table, victim, needed - room, evictedFrames);
+        } else {
+            evictWholeProcess(table, victim, evictedFrames);
+        }
+        room = groupRoom(table, process);
+    }
+    PROFILE_END();
+}
+
+// Map pages [firstPage, firstPage + pages) of process onto free aligned groups of
+// hugeFrames frames, huge pages first. A tail of at least half a huge page is rounded
+// up when freeFrames leaves room for it, the frames past its last page are wasted.
+// Return the number of pages mapped, the rest is left to base pages
+static int allocateHugePages(FrameTable *table, Process *process, int firstPage, int pages, int freeFrames) {
+    int size = table->hugeFrames;
+    int mapped = 0;
+    int used_frames = 0;
+    // Aligned groups are tried from the preferred node onwards
+    int span = size > 1 ? TOTAL_FRAMES / size * size : 0;
+    int first = size > 1 && table->numaNodes > 1 ? (nodeStart(table, table->preferredNode) + size - 1) / size * size : 0;
+    if (first >= span) first = 0;
+
+    for (int k = 0; size > 1 && k < span; k += size) {
+        int group = (first + k) % span;
+        int remaining = pages - mapped;
+        int used = remaining < size ? remaining : size;
+        if (used * 2 < size || freeFrames - used_frames - size < remaining - used) break;
+        if (!isGroupFree(table, group)) continue;
+
+        for (int i = 0; i < size; i++) {
+            Frame *frame = &table->frames[group + i];
+            chargeFrame(table, group + i, process, 1);
+            frame->process = process;
+            frame->huge = true;
+            frame->page_number = -1;
+            if (i < used) {
+                frame->page_number = firstPage + mapped + i;
+                process->frameAllocations[firstPage + mapped + i] = group + i;
+            }
+        }
+        mapped += used;
+        used_frames += size;
+        table->hugeWasteFrames += size - used;
+    }
+
+    // Enough pages for a whole huge page but fragmentation left no aligned group
+    if (size > 1 && pages - mapped >= size) table->hugeFallbacks++;
+    table->hugePagesMapped += mapped;
+    return mapped;
+}
+
+// A partial eviction breaks the huge page holding frame back into base pages
+static void splitHugePage(FrameTable *table, Frame *frame) {
+    if (!frame->huge) return;
+    int first = frame->frame_number - frame->frame_number % table->hugeFrames;
+    for (int i = first; i < first + table->hugeFrames; i++) {
+        table->frames[i].huge = false;
+    }
+    table->hugeSplits++;
+}
+
+// Print one EVICTED event listing every frame flagged in evictedFrames
+void printEvictedFrames(FrameTable *table, const int *evictedFrames, int simulationTime) {
+    int count = 0;
+    for (int i = 0; i < TOTAL_FRAMES; i++) count += evictedFrames[i];
+    if (count == 0) return;
+
+    int output_count = 0;
+    printEvent(table->output, "%d,EVICTED,evicted-frames=[", simulationTime);
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        // Assuming that a non-null process pointer means the frame is occupied
-        if (frames[i].process != NULL) {  
-            occupiedFrames++;
+        if (evictedFrames[i]) {
+            printEvent(table->output, "%d", i);
+            if (output_count < count - 1) {
+                printEvent(table->output, ",");
+            }
+            output_count++;
         }
     }
+    printEvent(table->output, "]\n");
+}
+
+int calculateMemoryUsage(FrameTable *table) {
+    // Occupied frames are counted as they are taken and freed
+    int occupiedFrames = table->framesUsed;
 
     // Calculate percentage of used frames
     int usagePercentage = (occupiedFrames * 100 + TOTAL_FRAMES - 1) / TOTAL_FRAMES;
@@ -33,97 +470,125 @@ int calculateMemoryUsage() {
 
 // Try to allocate pages and return 0 if successful, -1 otherwise
 // Updated to track allocated frames directly within the process structure
-int allocatePages(Process *process, int simulationTime) {
+int allocatePages(FrameTable *table, Process *process, int simulationTime) {
     int pages_needed = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
 
     if (process->frameAllocations == NULL) {
         // Ensure memory for frame allocation tracking
         process->frameAllocations = malloc(pages_needed * sizeof(int));  
+        for (int i = 0; i < pages_needed; i++) process->frameAllocations[i] = -1;
     }
 
     int *evictedFrames = (int *)(malloc(sizeof(int) * TOTAL_FRAMES));
     for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] = 0;
 
-    int free_frames = findFreeFrames();
-    while (free_frames < pages_needed) {
-        int *evictedFramesProcess = swapOutLeastRecentlyUsed(process, pages_needed - free_frames, simulationTime);
-        for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] |= evictedFramesProcess[i];
-        // Update count after attempting to free frames
-        free_frames = findFreeFrames();  
-        free(evictedFramesProcess);
-    }
+    // Shared pages already resident need no frame of their own
+    int slot;
+    int prefix = sharedPrefix(table, process, pages_needed, &slot);
+    int frames_needed = pages_needed - (prefix > 0 ? residentSharedPages(table, process, prefix, slot) : 0);
 
-    int count = 0;
-    for (int i = 0; i < TOTAL_FRAMES; i++) count += evictedFrames[i];
+    // A group over its limit reclaims from itself before anything is evicted globally
+    reclaimGroup(table, process, frames_needed, false, evictedFrames);
+    if (prefix > 0) frames_needed = pages_needed - residentSharedPages(table, process, prefix, slot);
 
-    if (count > 0) {
-        int output_count = 0;
-        printf("%d,EVICTED,evicted-frames=[", simulationTime);
-        for (int i = 0; i < TOTAL_FRAMES; i++) {
-            if (evictedFrames[i]) {
-                printf("%d", i);
-                if (output_count < count - 1) {
-                    printf(",");
-                }
-                output_count++;
-            }
-        }
-        printf("]\n");
+    int free_frames = findFreeFrames(table);
+    while (free_frames < frames_needed) {
+        int *evictedFramesProcess = swapOutLeastRecentlyUsed(table, process);
+        for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] |= evictedFramesProcess[i];
+        free(evictedFramesProcess);
+        // Update count after attempting to free frames
+        int previous_free_frames = free_frames;
+        free_frames = findFreeFrames(table);  
+        if (prefix > 0) frames_needed = pages_needed - residentSharedPages(table, process, prefix, slot);
+        // Every other resident process is running, nothing more can be evicted
+        if (free_frames == previous_free_frames) break;
     }
 
+    printEvictedFrames(table, evictedFrames, simulationTime);
     free(evictedFrames);
 
+    // Do not hand out a partial allocation, the process waits for memory instead
+    // A process larger than its group limit may still run alone in its group
+    if (free_frames < frames_needed ||
+        (groupRoom(table, process) < frames_needed && groupFrames(table, process->memoryGroup) > 0)) return -1;
+
     int allocated_pages = 0;
-    for (int i = 0; i < TOTAL_FRAMES && allocated_pages < pages_needed; i++) {
-        if (frames[i].process == NULL) {
-            frames[i].process = process;
-            frames[i].page_number = allocated_pages;
-            // Store the frame index
-            process->frameAllocations[allocated_pages] = i;  
-            allocated_pages++;
-        }
+    if (prefix > 0) {
+        mapSharedPrefix(table, process, prefix, slot);
+        allocated_pages = prefix;
+        free_frames = findFreeFrames(table);
+    }
+    allocated_pages += allocateHugePages(table, process, allocated_pages, pages_needed - allocated_pages, free_frames);
+    FramePicker picker;
+    initFramePicker(&picker, table, allocated_pages);
+    for (int i; allocated_pages < pages_needed && (i = pickFreeFrame(&picker)) != -1;) {
+        chargeFrame(table, i, process, 1);
+        table->frames[i].process = process;
+        table->frames[i].page_number = allocated_pages;
+        // Store the frame index
+        process->frameAllocations[allocated_pages] = i;  
+        allocated_pages++;
     }
 
     // Store number of frames actually allocated
     process->numFramesAllocated = allocated_pages;  
+    table->pagesMapped += allocated_pages;
+    noteFootprint(table);
     return allocated_pages == pages_needed ? 0 : -1;
 }
 
 // Evict pages of the least recently used process to make room for new pages
 // Updated to print evicted frame indices
-int *swapOutLeastRecentlyUsed(Process *currentProcess, int neededFrames, int simulationTime) {
+int *swapOutLeastRecentlyUsed(FrameTable *table, Process *currentProcess) {
+    PROFILE_BEGIN(PHASE_EVICTION);
     Process *least_recently_used = NULL;
     // Temporary storage for evicted frames
     int *evictedFrames = malloc(TOTAL_FRAMES * sizeof(int));  
     for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] = 0;
 
-    // Identify the least recently used process
-    for (int i = 0; i < TOTAL_FRAMES; i++) {
-        if (frames[i].process && frames[i].process != currentProcess &&
-            (!least_recently_used || frames[i].process->lastUsed < least_recently_used->lastUsed)) {
-            least_recently_used = frames[i].process;
-        }
-    }
-
-    // Evict all pages of the identified process
-    if (least_recently_used) {
+    // A process whose frames are all still mapped by others frees nothing, so keep
+    // evicting until a frame comes free or no process is left to evict
+    bool freed = false;
+    while (!freed) {
+        // Identify the least recently used process
+        least_recently_used = NULL;
+        PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
         for (int i = 0; i < TOTAL_FRAMES; i++) {
-            if (frames[i].process == least_recently_used) {
-                frames[i].process = NULL;
-                frames[i].page_number = -1;
-                evictedFrames[i] = 1;
+            if (table->frames[i].process && table->frames[i].process != currentProcess &&
+                table->frames[i].process->state != RUNNING && table->frames[i].process->state != BLOCKED &&
+                (!least_recently_used || table->frames[i].process->lastUsed < least_recently_used->lastUsed)) {
+                least_recently_used = table->frames[i].process;
             }
         }
-        free(least_recently_used->frameAllocations);
-        least_recently_used->frameAllocations = NULL;
-    }
+        if (!least_recently_used) break;
 
-    least_recently_used->isAllocated = false;
+        freed = evictWholeProcess(table, least_recently_used, evictedFrames);
+    }
 
+    PROFILE_END();
     return evictedFrames;
 }
 
-void deallocatePages(Process *process, int simulationTime) {
+// Evict all pages of victim and drop its page table, the unused tail of a huge page
+// holds nothing to write out. Return true if a frame came free
+static bool evictWholeProcess(FrameTable *table, Process *victim, int *evictedFrames) {
+    bool freed = false;
+    releaseSharedMappings(table, victim);
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
+    for (int i = 0; i < TOTAL_FRAMES; i++) {
+        if (table->frames[i].process == victim && releaseFrame(table, &table->frames[i], victim, true)) {
+            evictedFrames[i] = 1;
+            freed = true;
+        }
+    }
+    removeMapper(table, victim);
+    free(victim->frameAllocations);
+    victim->frameAllocations = NULL;
+    victim->isAllocated = false;
+    return freed;
+}
+
+void deallocatePages(FrameTable *table, Process *process, int simulationTime) {
     // Array to store evicted frame indices
     int *evictedFrames = malloc(TOTAL_FRAMES * sizeof(int));  
     if (!evictedFrames) {
@@ -133,11 +598,12 @@ void deallocatePages(Process *process, int simulationTime) {
     // Counter for the number of evicted frames
     int count = 0;  
 
-    // Iterate over all frames and deallocate those used by the process
+    // Iterate over all frames and deallocate those used by the process, shared frames
+    // stay with the processes still mapping them
+    releaseSharedMappings(table, process);
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        if (frames[i].process == process) {
-            frames[i].process = NULL;
-            frames[i].page_number = -1;
+        if (table->frames[i].process == process && releaseFrame(table, &table->frames[i], process, false)) {
             // Store the frame index that is being evicted
             evictedFrames[count] = i;  
             count++;
@@ -146,28 +612,32 @@ void deallocatePages(Process *process, int simulationTime) {
 
     // Print the evicted frames
     if (count > 0) {
-        printf("%d,EVICTED,evicted-frames=[", simulationTime);
+        printEvent(table->output, "%d,EVICTED,evicted-frames=[", simulationTime);
         for (int i = 0; i < count; i++) {
-            printf("%d", evictedFrames[i]);
+            printEvent(table->output, "%d", evictedFrames[i]);
             if (i < count - 1) {
-                printf(",");
+                printEvent(table->output, ",");
             }
         }
-        printf("]\n");
+        printEvent(table->output, "]\n");
     } else {
-        printf("No frames were evicted for Process %s\n", process->name);
+        printEvent(table->output, "No frames were evicted for Process %s\n", process->name);
     }
+    removeMapper(table, process);
 
     free(process->frameAllocations);
+    process->frameAllocations = NULL;
     // Free the memory allocated for tracking evicted frames
     free(evictedFrames);  
 }
 
 
 
-int allocateVirtualPages(Process *process, int simulationTime) {
+int allocateVirtualPages(FrameTable *table, Process *process, int simulationTime) {
     int total_pages_needed = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
     int min_required_pages = total_pages_needed < 4 ? total_pages_needed : 4;
+    int slot;
+    int prefix = sharedPrefix(table, process, total_pages_needed, &slot);
 
     if (process->frameAllocations == NULL) {
         process->frameAllocations = (int *)malloc(total_pages_needed * sizeof(int));
@@ -178,62 +648,264 @@ int allocateVirtualPages(Process *process, int simulationTime) {
         }
     }
 
-    int free_frames = findFreeFrames();
+    int free_frames = findFreeFrames(table);
 
     int *evicted_frames = (int *)(malloc(sizeof(int) * TOTAL_FRAMES));
     for (int i = 0; i < TOTAL_FRAMES; i++) evicted_frames[i] = 0;
+
+    // A group over its limit reclaims from itself before anything is evicted globally
+    if (process->memoryGroup >= 0 && min_required_pages > process->numFramesAllocated) {
+        reclaimGroup(table, process, min_required_pages - process->numFramesAllocated, true, evicted_frames);
+        free_frames = findFreeFrames(table);
+    }
     int pages_to_allocate = total_pages_needed - process->numFramesAllocated;
     while (free_frames < pages_to_allocate && free_frames < 4) {
 
         int frames_to_evict = min_required_pages - (process->numFramesAllocated + free_frames);
-        int *swapOutFrameProcess = swapOutFrames(process, frames_to_evict, simulationTime);
+        int *swapOutFrameProcess = swapOutFrames(table, process, frames_to_evict);
         for (int i = 0; i < TOTAL_FRAMES; i++) evicted_frames[i] |= swapOutFrameProcess[i];
         free(swapOutFrameProcess);
 
 
-        free_frames = findFreeFrames();  
+        int previous_free_frames = free_frames;
+        free_frames = findFreeFrames(table);  
 
-        
+        // Every other resident process is running, nothing more can be evicted
+        if (free_frames == previous_free_frames) break;
     }
-    int count = 0;
-    for (int i = 0; i < TOTAL_FRAMES; i++) count += evicted_frames[i];
-    if (count > 0) {
-        printf("%d,EVICTED,evicted-frames=[", simulationTime);
-        int count_output = 0;
-        for (int i = 0; i < TOTAL_FRAMES; i++) {
-            if (evicted_frames[i]) {
-                printf("%d", i);
-
-                if (count_output < count - 1) printf(",");
-                count_output++;
-            }
-        }
-        printf("]\n");
+    printEvictedFrames(table, evicted_frames, simulationTime);
+
+    // The shared prefix comes first, private pages follow it
+    if (prefix > 0) {
+        int shared_mapped = mapSharedPrefix(table, process, prefix, slot);
+        process->numFramesAllocated += shared_mapped;
+        table->pagesMapped += shared_mapped;
+        free_frames = findFreeFrames(table);
+        pages_to_allocate = total_pages_needed - process->numFramesAllocated;
     }
 
+    // Within the group limit, but never short of the pages the process needs to run
+    int room = groupRoom(table, process);
+    if (room < min_required_pages - process->numFramesAllocated) room = min_required_pages - process->numFramesAllocated;
+    if (pages_to_allocate > room) pages_to_allocate = room;
+
+    int huge_pages = pages_to_allocate < free_frames ? pages_to_allocate : free_frames;
+    int mapped = allocateHugePages(table, process, process->numFramesAllocated, huge_pages, free_frames);
+    process->numFramesAllocated += mapped;
+    table->pagesMapped += mapped;
+
     // Allocate as many pages as possible, but at least min_required_pages
-    for (int i = 0, frame_index = 0; frame_index < TOTAL_FRAMES && i < pages_to_allocate; frame_index++) {
-        if (frames[frame_index].process == NULL) {
-            frames[frame_index].process = process;
-            frames[frame_index].page_number = process->numFramesAllocated;
-            process->frameAllocations[process->numFramesAllocated] = frame_index;
-            process->numFramesAllocated++;
-            i++;
-        }
+    FramePicker picker;
+    initFramePicker(&picker, table, process->numFramesAllocated);
+    for (int i = mapped, frame_index; i < pages_to_allocate && (frame_index = pickFreeFrame(&picker)) != -1; i++) {
+        chargeFrame(table, frame_index, process, 1);
+        table->frames[frame_index].process = process;
+        table->frames[frame_index].page_number = process->numFramesAllocated;
+        process->frameAllocations[process->numFramesAllocated] = frame_index;
+        process->numFramesAllocated++;
+        table->pagesMapped++;
     }
 
     free(evicted_frames);
+    noteFootprint(table);
     return process->numFramesAllocated >= min_required_pages ? 0 : -1;  
 }
 
-int findFreeFrames() {
-    int count = 0;
+// Evict by LRU order until targetFreeFrames frames are free or nothing more can go.
+// Paged memory evicts whole processes, virtual memory only the frames it needs.
+// Return the number of frames evicted
+int reclaimFrames(FrameTable *table, int targetFreeFrames, bool partial, int simulationTime) {
+    long swappedBefore = table->framesSwappedOut;
+    int evictedFrames[TOTAL_FRAMES] = {0};
+
+    int free_frames = findFreeFrames(table);
+    while (free_frames < targetFreeFrames) {
+        int needed = targetFreeFrames - free_frames;
+        int *evicted = partial ? swapOutFrames(table, NULL, needed)
+                               : swapOutLeastRecentlyUsed(table, NULL);
+        for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] |= evicted[i];
+        free(evicted);
+
+        int previous_free_frames = free_frames;
+        free_frames = findFreeFrames(table);
+        if (free_frames == previous_free_frames) break;
+    }
+
+    printEvictedFrames(table, evictedFrames, simulationTime);
+    return (int)(table->framesSwappedOut - swappedBefore);
+}
+
+// Demand paging: reference page of process, whose frameAllocations is indexed by page
+// number. A page that is not resident faults into a free frame, else one taken from the
+// least recently used other process, else the least recently referenced page of process
+// itself. Frames taken are flagged in evictedFrames. Return 0 on a hit, 1 on a fault
+// and -1 on a fault that found no frame at all
+int touchPage(FrameTable *table, Process *process, int page, int *evictedFrames) {
+    table->referenceClock++;
+    int frame_index = process->frameAllocations[page];
+    if (frame_index != -1) {
+        table->frames[frame_index].lastReference = table->referenceClock;
+        return 0;
+    }
+
+    int slot;
+    int pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (page >= sharedPrefix(table, process, pages, &slot) || isPrivateCopy(process, page)) slot = -1;
+    if (slot >= 0 && table->segments[slot].frames[page] != -1) {
+        // Another process brought the shared page in, only the page table changes
+        mapPage(table, process, page, -1, slot);
+        process->numFramesAllocated++;
+        table->pagesMapped++;
+        noteFootprint(table);
+        return 0;
+    }
+    table->pageFaults++;
+
+    // A group at its limit takes the frame from its own processes first
+    reclaimGroup(table, process, 1, true, evictedFrames);
+    if (groupRoom(table, process) >= 1) {
+        frame_index = firstFreeFrame(table, page);
+        if (frame_index == -1) {
+            int *evicted = swapOutFrames(table, process, 1);
+            for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] |= evicted[i];
+            free(evicted);
+            frame_index = firstFreeFrame(table, page);
+        }
+    }
+    if (frame_index == -1) {
+        // Every other resident process is running, or the group is at its limit,
+        // replace one of our own pages
+        for (int i = 0; i < TOTAL_FRAMES; i++) {
+            Frame *frame = &table->frames[i];
+            if (frame->process == process && frame->page_number >= 0 && frame->sharers <= 1 &&
+                (frame_index == -1 || frame->lastReference < table->frames[frame_index].lastReference)) {
+                frame_index = i;
+            }
+        }
+        if (frame_index == -1) return -1;
+
+        Frame *victim = &table->frames[frame_index];
+        splitHugePage(table, victim);
+        process->frameAllocations[victim->page_number] = -1;
+        process->numFramesAllocated--;
+        releaseFrame(table, victim, process, true);
+        evictedFrames[frame_index] = 1;
+    }
+
+    mapPage(table, process, page, frame_index, slot);
+    process->numFramesAllocated++;
+    table->pagesMapped++;
+    noteFootprint(table);
+    return 1;
+}
+
+// A write to a shared page gives process a private copy. The last process mapping the
+// page takes its frame over, otherwise the page is copied into a free frame. Making room
+// evicts frames of one process with partial, whole processes otherwise. Return 1 if the
+// page was copied, 0 if no copy was needed and -1 if no frame could be found for the copy
+int copyOnWrite(FrameTable *table, Process *process, int page, bool partial, int *evictedFrames) {
+    int frame_index = process->frameAllocations[page];
+    if (frame_index == -1 || table->frames[frame_index].segment < 0) return 0;
+    if (!process->privateCopies) {
+        int pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+        process->privateCopies = calloc(pages, sizeof(bool));
+        if (!process->privateCopies) return -1;
+    }
+
+    Frame *frame = &table->frames[frame_index];
+    if (frame->sharers == 1) {
+        table->segments[frame->segment].frames[page] = -1;
+        frame->segment = -1;
+        frame->sharers = 0;
+        process->privateCopies[page] = true;
+        return 0;
+    }
+
+    reclaimGroup(table, process, 1, partial, evictedFrames);
+    if (groupRoom(table, process) < 1) return -1;
+    int copy_index = firstFreeFrame(table, page);
+    if (copy_index == -1) {
+        int *evicted = partial ? swapOutFrames(table, process, 1)
+                               : swapOutLeastRecentlyUsed(table, process);
+        for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] |= evicted[i];
+        free(evicted);
+        copy_index = firstFreeFrame(table, page);
+    }
+    if (copy_index == -1) return -1;
+
+    releaseFrame(table, frame, process, false);
+    process->privateCopies[page] = true;
+    mapPage(table, process, page, copy_index, -1);
+    table->cowCopies++;
+    noteFootprint(table);
+    return 1;
+}
+
+// Evict every frame of process, keeping its page table so it can fault or load back in.
+// Return the number of pages written out
+int swapOutProcess(FrameTable *table, Process *process, int simulationTime) {
+    int evictedFrames[TOTAL_FRAMES] = {0};
+    PROFILE_BEGIN(PHASE_EVICTION);
+    long swappedBefore = table->framesSwappedOut;
+    releaseSharedMappings(table, process);
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        if (frames[i].process == NULL) {
-            count++;
+        Frame *frame = &table->frames[i];
+        if (frame->process == process && releaseFrame(table, frame, process, true)) {
+            evictedFrames[i] = 1;
         }
     }
-    return count;
+    printEvictedFrames(table, evictedFrames, simulationTime);
+    removeMapper(table, process);
+    int pages = (int)(table->framesSwappedOut - swappedBefore);
+
+    if (process->frameAllocations) {
+        int total_pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+        for (int i = 0; i < total_pages; i++) process->frameAllocations[i] = -1;
+    }
+    process->numFramesAllocated = 0;
+    process->isAllocated = false;
+    PROFILE_END();
+    return pages;
+}
+
+// Move the private base pages of process held on other nodes into free frames of node,
+// as far as node has room. Nothing is written out. Return the number of pages moved
+int migratePages(FrameTable *table, Process *process, int node) {
+    if (!process->frameAllocations || node < 0 || node >= table->numaNodes) return 0;
+    int total_pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+    int next = nodeStart(table, node);
+    int end = nodeStart(table, node + 1);
+    int moved = 0;
+
+    for (int page = 0; page < total_pages && next < end; page++) {
+        int from = process->frameAllocations[page];
+        if (from < 0 || frameNode(table, from) == node) continue;
+        Frame *old = &table->frames[from];
+        if (old->process != process || old->huge || old->segment != -1) continue;
+
+        while (next < end && table->frames[next].process != NULL) next++;
+        if (next == end) break;
+        Frame *frame = &table->frames[next];
+        chargeFrame(table, from, process, -1);
+        chargeFrame(table, next, process, 1);
+        frame->process = process;
+        frame->page_number = old->page_number;
+        frame->lastReference = old->lastReference;
+        old->process = NULL;
+        old->page_number = -1;
+        old->lastReference = 0;
+        process->frameAllocations[page] = next;
+        moved++;
+    }
+    table->pagesMigrated += moved;
+    if (moved > 0) noteFootprint(table);
+    return moved;
+}
+
+// Every frame taken or freed goes through chargeFrame, so the count needs no scan
+int findFreeFrames(FrameTable *table) {
+    return TOTAL_FRAMES - table->framesUsed;
 }
 
 void printSortedFrames(Frame **frames, int count) {
@@ -251,29 +923,37 @@ void printSortedFrames(Frame **frames, int count) {
 }
 
 // Allocate virtual pages
-int *swapOutFrames(Process *currentProcess, int neededFrames, int simulationTime) {
-    Process *least_recently_used = findLeastRecentlyUsedProcess(currentProcess);
+int *swapOutFrames(FrameTable *table, Process *currentProcess, int neededFrames) {
+    PROFILE_BEGIN(PHASE_EVICTION);
+    Process *least_recently_used = findLeastRecentlyUsedProcess(table, currentProcess);
 
     int *evictedFrames = (int *)(malloc(sizeof(int) * TOTAL_FRAMES));
     for (int i = 0; i < TOTAL_FRAMES; i++) evictedFrames[i] = 0;
 
     // No process to evict frames from
-    if (!least_recently_used) return 0;  
+    if (least_recently_used) evictFramesOf(table, least_recently_used, neededFrames, evictedFrames);
+    PROFILE_END();
+    return evictedFrames;
+}
 
+// Evict neededFrames frames of least_recently_used, all of them if it has no more,
+// flagging them in evictedFrames
+static void evictFramesOf(FrameTable *table, Process *least_recently_used, int neededFrames, int *evictedFrames) {
     Frame *sortedFrames[TOTAL_FRAMES];
-    int count = collectFrames(least_recently_used, sortedFrames);  
+    int count = collectFrames(table, least_recently_used, sortedFrames);  
+    // Holes left by earlier evictions must not walk the search off the page table
+    int total_pages = (least_recently_used->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
 
-    if (count == 0) return evictedFrames;  
+    if (count == 0) return;  
 
     if (count <= neededFrames) {
         // Evict all pages in the least_recently_used
         for (int i = 0; i < count; i++) {
-            sortedFrames[i]->process = NULL;
-            sortedFrames[i]->page_number = -1;
+            releaseFrame(table, sortedFrames[i], least_recently_used, true);
             evictedFrames[sortedFrames[i]->frame_number] = 1;  
 
             int n = least_recently_used->numFramesAllocated;
-            for (int j = 0; j < n; j++) {
+            for (int j = 0; j < n && j < total_pages; j++) {
                 if (least_recently_used->frameAllocations[j] == -1) {
                     n++;
                     continue;
@@ -294,8 +974,8 @@ int *swapOutFrames(Process *currentProcess, int neededFrames, int simulationTime
         for (int i = 0; i < neededFrames; i++) {
             Frame *frame = sortedFrames[i];
 
-            frame->process = NULL;
-            frame->page_number = -1;
+            splitHugePage(table, frame);
+            releaseFrame(table, frame, least_recently_used, true);
 
             evictedFrames[frame->frame_number] = 1;  // Save
 
@@ -304,7 +984,7 @@ int *swapOutFrames(Process *currentProcess, int neededFrames, int simulationTime
             // evict frame from least_recently_used->frameAllocations;
             // Find index of frame
             int n = least_recently_used->numFramesAllocated;
-            for (int j = 0; j < n; j++) {
+            for (int j = 0; j < n && j < total_pages; j++) {
                 if (least_recently_used->frameAllocations[j] == -1) {
                     n++;
                     continue;
@@ -317,23 +997,29 @@ int *swapOutFrames(Process *currentProcess, int neededFrames, int simulationTime
             }
         }
     }
-
-
-    return evictedFrames;
 }
 
 // Finds the least recently used process among those allocated in the memory frames,
-// excluding the current process.
-Process *findLeastRecentlyUsedProcess(Process *currentProcess) {
+// excluding the current process. Shared frames other processes still map do not count,
+// evicting them would free nothing.
+Process *findLeastRecentlyUsedProcess(FrameTable *table, Process *currentProcess) {
+    return leastRecentlyUsed(table, currentProcess, -1);
+}
+
+// Same within memory group, any process when group is -1
+static Process *leastRecentlyUsed(FrameTable *table, Process *currentProcess, int group) {
     Process *least_recently_used = NULL;
     int oldest_time = INT_MAX;
 
     // Traverse all frames to find the least recently used process
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        if (frames[i].process != NULL && frames[i].process != currentProcess) {
-            if (frames[i].process->lastUsed < oldest_time) {
-                oldest_time = frames[i].process->lastUsed;
-                least_recently_used = frames[i].process;
+        if (table->frames[i].process != NULL && table->frames[i].process != currentProcess && table->frames[i].sharers <= 1 &&
+            (group < 0 || table->frames[i].process->memoryGroup == group) &&
+            table->frames[i].process->state != RUNNING && table->frames[i].process->state != BLOCKED) {
+            if (table->frames[i].process->lastUsed < oldest_time) {
+                oldest_time = table->frames[i].process->lastUsed;
+                least_recently_used = table->frames[i].process;
             }
         }
     }
@@ -341,11 +1027,13 @@ Process *findLeastRecentlyUsedProcess(Process *currentProcess) {
     return least_recently_used;
 }
 
-int collectFrames(Process *process, Frame **sortedFrames) {
+// Collect the frames of process that evicting would free
+int collectFrames(FrameTable *table, Process *process, Frame **sortedFrames) {
     int index = 0;
+    PROFILE_COUNT(COUNT_FRAMES_SCANNED, TOTAL_FRAMES);
     for (int i = 0; i < TOTAL_FRAMES; i++) {
-        if (frames[i].process == process) {
-            sortedFrames[index++] = &frames[i];
+        if (table->frames[i].process == process && table->frames[i].sharers <= 1) {
+            sortedFrames[index++] = &table->frames[i];
         }
     }
     return index;
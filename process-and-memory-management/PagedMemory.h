@@ -1,29 +1,101 @@
 #ifndef PAGED_MEMORY_H
 #define PAGED_MEMORY_H
 
+#include <stdbool.h>
+#include <stdio.h>
+
 #include "Process.h"
 
 // Total frames in memory based on 2048 KB total and 4 KB per frame
 #define TOTAL_FRAMES 512 
 #define PAGE_SIZE 4 
+// Distinct shared segments one frame table tracks
+#define MAX_SHARED_SEGMENTS 64
+// Memory group ids run from 0 to MAX_MEMORY_GROUPS - 1
+#define MAX_MEMORY_GROUPS 16
+// Memory nodes frames and contiguous memory can be split into
+#define MAX_NUMA_NODES 8
 
 typedef struct {
     int frame_number; // Frame number
     Process *process; // Process in a frame
-    int page_number; // Page number of a frame
+    int page_number; // Page number of a frame, -1 for the unused tail of a huge page
+    bool huge; // Part of a huge page, an aligned group of hugeFrames frames of one process
+    long lastReference; // Reference clock of the last demand paging access
+    int segment; // Shared segment slot the frame belongs to, -1 for a private frame
+    int sharers; // Page tables mapping a shared frame, its process is one of them
 } Frame;
 
-void initializeFrames();
-int calculateMemoryUsage();
-int allocatePages(Process *process, int simulationTime);
-void deallocatePages(Process *process, int simulationTime);
-int findFreeFrames();
-int* swapOutLeastRecentlyUsed(Process *currentProcess, int neededFrames, int simulationTime);
-int allocateVirtualPages(Process *process, int simulationTime);
-int *swapOutFrames(Process *currentProcess, int neededFrames, int simulationTime);
+// Pages several processes map from the same frames, like a shared library
+typedef struct {
+    int id; // Segment id given in the input
+    int pages; // Pages in the segment
+    int *frames; // Resident frame of each page, -1 when it is not resident
+    Process **mappers; // Processes that may map pages of the segment
+    int mapperCount; // Number of mappers
+    int mapperCapacity; // Slots allocated for mappers
+} SharedSegment;
+
+// Processes charged together against one memory limit, like a memory cgroup
+typedef struct {
+    bool used; // Some process of the group has asked for frames
+    int frames; // Frames its processes hold
+    int limitFrames; // Frames the group may hold, the tightest limit its processes give, 0 for none
+    int peakFrames; // Most frames the group held at once
+    long framesEvicted; // Frames evicted from its processes
+    int reclaims; // Times it evicted its own processes to get back within its limit
+} MemoryGroup;
+
+// Frame table of one simulation, so several simulations can run side by side
+typedef struct {
+    Frame frames[TOTAL_FRAMES]; // Physical frames
+    FILE *output; // Where EVICTED events go, NULL to stay quiet
+    long framesSwappedOut; // Frames evicted from resident processes so far
+    int hugeFrames; // Frames per huge page, 0 allocates base pages only
+    long pagesMapped; // Pages given frames by allocations so far
+    long hugePagesMapped; // Of those, pages that landed in a huge page
+    long hugeWasteFrames; // Frames of huge pages past the last page of their process
+    int hugeFallbacks; // Allocations that wanted a huge page but found no free aligned group
+    int hugeSplits; // Huge pages split into base pages by a partial eviction
+    long referenceClock; // Page references made under demand paging
+    SharedSegment segments[MAX_SHARED_SEGMENTS]; // Shared segments seen so far
+    int segmentCount; // Number of segments in use
+    long sharedPagesMapped; // Shared pages mapped so far
+    long sharedFramesReused; // Of those, pages that found their frame already resident
+    long cowCopies; // Shared pages copied into a private frame on write
+    int extraMappings; // Mappings of resident shared frames beyond the first
+    int peakFramesUsed; // Most frames in use at once, the physical footprint
+    int peakPagesMapped; // Most pages mapped at once, counting each mapping of a shared frame
+    MemoryGroup groups[MAX_MEMORY_GROUPS]; // Memory groups by id
+    int numaNodes; // Memory nodes the frames are split into evenly, 1 without NUMA
+    int preferredNode; // Node allocations fill first, the node of the core about to run the process
+    bool interleave; // Spread the pages of a process over the nodes in turn instead
+    int nodePeakFrames[MAX_NUMA_NODES]; // Most frames each node held at once
+    long pagesMigrated; // Pages moved to the node of the core their process was scheduled on
+    int framesUsed; // Frames in use, kept up to date so no scan is needed
+    int nodeFrames[MAX_NUMA_NODES]; // Frames in use on each node
+    long pageFaults; // References under demand paging that found their page not resident
+} FrameTable;
+
+void initializeFrames(FrameTable *table, FILE *output);
+void freeFrameTable(FrameTable *table);
+int frameNode(FrameTable *table, int frame);
+int migratePages(FrameTable *table, Process *process, int node);
+int calculateMemoryUsage(FrameTable *table);
+int allocatePages(FrameTable *table, Process *process, int simulationTime);
+void deallocatePages(FrameTable *table, Process *process, int simulationTime);
+int findFreeFrames(FrameTable *table);
+int touchPage(FrameTable *table, Process *process, int page, int *evictedFrames);
+int copyOnWrite(FrameTable *table, Process *process, int page, bool partial, int *evictedFrames);
+void printEvictedFrames(FrameTable *table, const int *evictedFrames, int simulationTime);
+int swapOutProcess(FrameTable *table, Process *process, int simulationTime);
+int reclaimFrames(FrameTable *table, int targetFreeFrames, bool partial, int simulationTime);
+int* swapOutLeastRecentlyUsed(FrameTable *table, Process *currentProcess);
+int allocateVirtualPages(FrameTable *table, Process *process, int simulationTime);
+int *swapOutFrames(FrameTable *table, Process *currentProcess, int neededFrames);
 int frameCompare(const void *a, const void *b);
-Process *findLeastRecentlyUsedProcess(Process *currentProcess);
-int collectFrames(Process *process, Frame **sortedFrames);
+Process *findLeastRecentlyUsedProcess(FrameTable *table, Process *currentProcess);
+int collectFrames(FrameTable *table, Process *process, Frame **sortedFrames);
 void evictFrames(Frame **frames, int count, int simulationTime);
 void printSortedFrames(Frame **frames, int count);
 
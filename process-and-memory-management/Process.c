@@ -1,13 +1,20 @@
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "Process.h"
+#include "PagedMemory.h"
+#include "Profile.h"
 
 const char* processStateNames[] = {
     "NEW",    // Corresponds to NEW
     "READY",  // Corresponds to READY
     "RUNNING",// Corresponds to RUNNING
-    "FINISHED"// Corresponds to FINISHED
+    "FINISHED",// Corresponds to FINISHED
+    "BLOCKED", // Corresponds to BLOCKED
+    "SUSPENDED", // Corresponds to SUSPENDED
+    "WAITING"  // Corresponds to WAITING
 };
 
 
@@ -18,25 +25,127 @@ void printProcessDetails(Process *process) {
 }
 
 // Print all of the memory frames
-void printMemoryFrames(const Process *process) {
+void printMemoryFrames(FILE *output, const Process *process) {
+    if (!output) {
+        return;
+    }
 
     if (process->numFramesAllocated > 0 && process->frameAllocations != NULL) {
-        printf("mem-frames=[");
+        fprintf(output, "mem-frames=[");
         int printing = process->numFramesAllocated;
         for (int i = 0; i < printing; i++) {
             if (process->frameAllocations[i] == -1) {
                 printing++;
                 continue;
             }
-            printf("%d", process->frameAllocations[i]);
+            fprintf(output, "%d", process->frameAllocations[i]);
             if (i < printing - 1) {
-            printf(",");
+            fprintf(output, ",");
             }
    
             
         }
-        printf("]\n");
+        fprintf(output, "]\n");
     } else {
-        printf("Mem-frames %s: None\n", process->name);
+        fprintf(output, "Mem-frames %s: None\n", process->name);
+    }
+}
+
+// Print part of an event line, or nothing when output is NULL (quiet simulations)
+void printEvent(FILE *output, const char *format, ...) {
+    if (!output) {
+        return;
+    }
+    PROFILE_BEGIN(PHASE_OUTPUT);
+    va_list args;
+    va_start(args, format);
+    vfprintf(output, format, args);
+    va_end(args);
+    PROFILE_END();
+}
+
+// Copy a process as read from the input, before any simulation touched it
+Process* copyProcess(const Process *process) {
+    Process *copy = (Process *)malloc(sizeof(Process));
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, process, sizeof(Process));
+    copy->frameAllocations = NULL;
+    copy->numFramesAllocated = 0;
+    copy->workingSet = NULL;
+    copy->privateCopies = NULL;
+    if (process->referenceModel) {
+        copy->referenceModel = copyReferenceModel(process->referenceModel);
+        if (!copy->referenceModel) {
+            free(copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+// Free a process with everything it owns
+void freeProcess(Process *process) {
+    free(process->frameAllocations);
+    freeReferenceModel(process->referenceModel);
+    freeWorkingSet(process->workingSet);
+    free(process->privateCopies);
+    free(process);
+}
+
+// Parse the optional columns after the memory requirement. Return -1 on a malformed one
+int parseProcessColumns(Process *process, char *columns) {
+    char *position;
+    for (char *column = strtok_r(columns, " \t\r\n", &position); column; column = strtok_r(NULL, " \t\r\n", &position)) {
+        int id, size;
+        char extra;
+        if (strncmp(column, "shared:", 7) == 0) {
+            if (sscanf(column, "shared:%d:%d%c", &id, &size, &extra) != 2 || id < 0 || size < 0) {
+                return -1;
+            }
+            process->sharedSegment = id;
+            process->sharedPages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+        } else if (strncmp(column, "group:", 6) == 0) {
+            int limit = 0;
+            int fields = sscanf(column, "group:%d:%d%c", &id, &limit, &extra);
+            if ((fields != 1 && fields != 2) || id < 0 || id >= MAX_MEMORY_GROUPS || limit < 0 ||
+                (fields == 1 && strchr(column + 6, ':'))) {
+                return -1;
+            }
+            process->memoryGroup = id;
+            process->groupLimit = limit;
+        } else if (process->referenceModel || !(process->referenceModel = parseReferenceModel(column))) {
+            return -1;
+        }
     }
-}
\ No newline at end of file
+    return 0;
+}
+
+// Every field the input does not give
+void initializeInputProcess(Process *process) {
+    process->remainingTime = process->serviceTime;
+    process->state = NEW;
+    process->memoryAddress = -1;
+    process->isAllocated = false;
+    process->lastUsed = 0;
+    process->numFramesAllocated = 0;
+    process->frameAllocations = NULL;
+    process->vruntime = 0;
+    process->priority = 0;
+    process->lastCpu = -1;
+    process->swappedPages = 0;
+    process->blockedUntil = 0;
+    process->pageReferences = 0;
+    process->pageFaults = 0;
+    process->referenceModel = NULL;
+    process->workingSet = NULL;
+    process->sharedSegment = -1;
+    process->sharedPages = 0;
+    process->privateCopies = NULL;
+    process->memoryGroup = -1;
+    process->groupLimit = 0;
+    process->id = 0;
+    process->stateSince = 0;
+    process->firstRunTime = -1;
+}
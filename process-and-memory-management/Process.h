@@ -3,15 +3,24 @@
 #define PROCESS_H
 
 #include <stdbool.h>
+#include <stdio.h>
+
+#include "PageReferences.h"
+#include "WorkingSet.h"
 
 // Enum for process state
 typedef enum {
     NEW,        // Process has arrived but not yet entered the queue
     READY,      // Process is in the queue ready to run
     RUNNING,    // Process is currently running
-    FINISHED    // Process has completed execution
+    FINISHED,   // Process has completed execution
+    BLOCKED,    // Process is waiting for swap I/O
+    SUSPENDED,  // Process was swapped out whole by the load controller
+    WAITING     // Process could not be given memory and waits for some to be freed
 } ProcessState;
 
+extern const char* processStateNames[];
+
 // Struct for a process
 typedef struct {
     char name[9];          // Process name (up to 8 characters + null terminator)
@@ -28,9 +37,31 @@ typedef struct {
     bool isAllocated;         // Check if a process is allocated to memory or not
     int *frameAllocations;      // Array of frame numbers allocated to this process
     int numFramesAllocated;     // Number of frames allocated  
+    long vruntime;              // Virtual runtime consumed under the fair scheduler
+    int priority;               // Feedback queue level, 0 is the highest
+    int lastCpu;                // Core the process last ran on, -1 if it never ran
+    int swappedPages;           // Pages evicted to the swap device and not read back yet
+    int blockedUntil;           // Time the pending swap I/O of a blocked process completes
+    long pageReferences;        // Page references generated so far, the position in its reference pattern
+    ReferenceModel *referenceModel; // Pages it touches, NULL walks its pages in order
+    long pageFaults;            // References that found their page not resident
+    WorkingSet *workingSet;     // Pages referenced recently, NULL until it first runs with tracking on
+    int sharedSegment;          // Shared segment its leading pages map, -1 when every page is private
+    int sharedPages;            // Leading pages mapped from the shared segment
+    bool *privateCopies;        // Shared pages it has copied on write, NULL until the first copy
+    int memoryGroup;            // Memory group its frames are charged to, -1 outside any group
+    int groupLimit;             // Memory limit in KB it gives for its group, 0 for none
+    int id;                     // Order it was added to the simulation in, its track in a trace
+    int stateSince;             // Time it entered its current state
+    int firstRunTime;           // Time it first ran, -1 until then
 } Process;
 
 void printProcessDetails(Process *process);
-void printMemoryFrames(const Process *process);
+void printMemoryFrames(FILE *output, const Process *process);
+void printEvent(FILE *output, const char *format, ...);
+Process* copyProcess(const Process *process);
+void freeProcess(Process *process);
+void initializeInputProcess(Process *process);
+int parseProcessColumns(Process *process, char *columns);
 
 #endif
@@ -0,0 +1,110 @@
+#include "Profile.h"
+
+#ifdef PROFILE
+
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Deepest nesting of phases that is tracked, deeper phases charge their parent
+#define PROFILE_DEPTH 16
+
+unsigned long long profileCounters[PROFILE_COUNTERS];
+
+static const char *phaseNames[PROFILE_PHASES] = {"other", "arrival", "allocation", "eviction", "dispatch", "output"};
+static const char *counterNames[PROFILE_COUNTERS] = {"frames-scanned", "holes-traversed", "evictions", "queue-ops", "mallocs"};
+
+static unsigned long long phaseTicks[PROFILE_PHASES];
+static unsigned long long phaseEntries[PROFILE_PHASES];
+static ProfilePhase phaseStack[PROFILE_DEPTH];
+static int depth;
+static unsigned long long lastTick;
+
+// The time stamp counter where there is one, nanoseconds elsewhere
+#if defined(__x86_64__) || defined(__i386__)
+#define TICK_UNIT "cycles"
+static unsigned long long readTicks(void) {
+    return __rdtsc();
+}
+#else
+#define TICK_UNIT "ns"
+static unsigned long long readTicks(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+#endif
+
+static ProfilePhase currentPhase(void) {
+    if (depth == 0) {
+        return PHASE_OTHER;
+    }
+    return phaseStack[(depth < PROFILE_DEPTH ? depth : PROFILE_DEPTH) - 1];
+}
+
+// Charge the time since the last switch to the running phase
+static void chargeCurrent(void) {
+    unsigned long long now = readTicks();
+    if (lastTick != 0) {
+        phaseTicks[currentPhase()] += now - lastTick;
+    }
+    lastTick = now;
+}
+
+void profileEnter(ProfilePhase phase) {
+    chargeCurrent();
+    if (depth < PROFILE_DEPTH) {
+        phaseStack[depth] = phase;
+    }
+    depth++;
+    phaseEntries[phase]++;
+}
+
+void profileLeave(void) {
+    chargeCurrent();
+    if (depth > 0) {
+        depth--;
+    }
+}
+
+void printProfile(FILE *output) {
+    chargeCurrent();
+    fprintf(output, "profile");
+    for (int i = 0; i < PROFILE_COUNTERS; i++) {
+        fprintf(output, ",%s=%llu", counterNames[i], profileCounters[i]);
+    }
+    fprintf(output, "\n");
+
+    unsigned long long total = 0;
+    for (int i = 0; i < PROFILE_PHASES; i++) {
+        total += phaseTicks[i];
+    }
+    for (int i = 0; i < PROFILE_PHASES; i++) {
+        fprintf(output, "profile,phase=%s,%s=%llu,share=%.1f%%,entries=%llu\n", phaseNames[i], TICK_UNIT, phaseTicks[i],
+                total > 0 ? phaseTicks[i] * 100.0 / total : 0.0, phaseEntries[i]);
+    }
+}
+
+// Allocation calls are counted by linking with --wrap, see the Makefile
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    profileCounters[COUNT_MALLOCS]++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    profileCounters[COUNT_MALLOCS]++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    profileCounters[COUNT_MALLOCS]++;
+    return __real_realloc(pointer, size);
+}
+
+#endif
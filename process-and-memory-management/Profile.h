@@ -0,0 +1,49 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+
+// Hot-path counters and phase timers behind --profile. They are only built with
+// make PROFILE=1, otherwise every macro below expands to nothing and costs nothing
+
+typedef enum {
+    PHASE_OTHER,      // Loop bookkeeping and anything outside the phases below
+    PHASE_ARRIVAL,    // Moving arrived processes to the ready queue
+    PHASE_ALLOCATION, // Allocating and freeing memory, eviction excluded
+    PHASE_EVICTION,   // Choosing victims and evicting their frames
+    PHASE_DISPATCH,   // Picking the next process to run
+    PHASE_OUTPUT,     // Printing events
+    PROFILE_PHASES
+} ProfilePhase;
+
+typedef enum {
+    COUNT_FRAMES_SCANNED,  // Frame table entries looked at
+    COUNT_HOLES_TRAVERSED, // Holes walked by first fit
+    COUNT_EVICTIONS,       // Frames evicted
+    COUNT_QUEUE_OPS,       // Ready queue insertions and removals
+    COUNT_MALLOCS,         // malloc, calloc and realloc calls
+    PROFILE_COUNTERS
+} ProfileCounter;
+
+#ifdef PROFILE
+
+extern unsigned long long profileCounters[PROFILE_COUNTERS];
+
+// Phases nest, time is charged to the innermost one so each phase is exclusive
+void profileEnter(ProfilePhase phase);
+void profileLeave(void);
+void printProfile(FILE *output);
+
+#define PROFILE_COUNT(counter, n) (profileCounters[counter] += (n))
+#define PROFILE_BEGIN(phase) profileEnter(phase)
+#define PROFILE_END() profileLeave()
+
+#else
+
+#define PROFILE_COUNT(counter, n) ((void)0)
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END() ((void)0)
+
+#endif
+
+#endif
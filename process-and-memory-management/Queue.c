@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include "Queue.h"
 #include "Process.h"
+#include "Profile.h"
 
 Node* createNode(Process* data) {
     Node* newNode = (Node*) malloc(sizeof(Node));
@@ -36,6 +37,7 @@ Queue* createQueue() {
 
 // Enqueue a new process
 void enqueue(Queue* queue, Process* process) {
+    PROFILE_COUNT(COUNT_QUEUE_OPS, 1);
     Node* newNode = createNode(process);
     if (!newNode) {
         return;
@@ -54,6 +56,7 @@ Process* dequeue(Queue* queue) {
     if (isQueueEmpty(queue)) {
         return NULL;
     }
+    PROFILE_COUNT(COUNT_QUEUE_OPS, 1);
     Node* temp = queue->front;
     Process* process = temp->data;
     queue->front = temp->next;
@@ -71,8 +74,7 @@ void freeQueue(Queue* queue) {
     Node* next;
     while (current != NULL) {
         next = current->next;
-        free(current->data->frameAllocations);
-        free(current->data);
+        freeProcess(current->data);
         freeNode(current);
         current = next;
     }
@@ -92,6 +94,38 @@ Process* peek(Queue* queue) {
 }
 
 
+// Move every node of other to the rear of queue, leaving other empty
+void appendQueue(Queue* queue, Queue* other) {
+    if (isQueueEmpty(other)) {
+        return;
+    }
+    if (!queue->rear) {
+        queue->front = other->front;
+    } else {
+        queue->rear->next = other->front;
+    }
+    queue->rear = other->rear;
+    queue->count += other->count;
+    other->front = NULL;
+    other->rear = NULL;
+    other->count = 0;
+}
+// Copy a queue of unscheduled processes, giving the copy its own Process structures
+Queue* copyQueue(Queue* queue) {
+    Queue* copy = createQueue();
+    if (copy == NULL) {
+        return NULL;
+    }
+    for (Node* current = queue->front; current != NULL; current = current->next) {
+        Process* process = copyProcess(current->data);
+        if (process == NULL) {
+            freeQueue(copy);
+            return NULL;
+        }
+        enqueue(copy, process);
+    }
+    return copy;
+}
 
 void printQueueContents(Queue* queue) {
     if (isQueueEmpty(queue)) {
@@ -27,6 +27,8 @@ Process* dequeue(Queue* queue);
 void freeQueue(Queue* queue);
 int isQueueEmpty(Queue* queue);
 Process* peek(Queue* queue);
+void appendQueue(Queue* queue, Queue* other);
+Queue* copyQueue(Queue* queue);
 void printQueueContents(Queue* queue);
 
 #endif
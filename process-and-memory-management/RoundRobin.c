@@ -0,0 +1,489 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "Process.h"
+#include "Queue.h"
+#include "ContiguousMemory.h"
+#include "PagedMemory.h"
+#include "RoundRobin.h"
+#include "Workload.h"
+#include "Profile.h"
+
+// Position in a mapped workload whose processes are created as the loop reaches them
+typedef struct {
+    const Workload *workload; // NULL when the whole input is already queued
+    long next; // Index of the next process to create
+    SchedulerStats *stats;
+} WorkloadCursor;
+
+// Create the next process of a mapped workload once every queued one has arrived
+static void refillArrivals(Queue *allProcesses, WorkloadCursor *cursor) {
+    const Workload *workload = cursor->workload;
+    if (!workload || !isQueueEmpty(allProcesses) || cursor->next >= workload->count) {
+        return;
+    }
+    Process *process = createWorkloadProcess(workload, cursor->next);
+    if (!process) {
+        // The rest of the input is dropped, like a text input that fails to load
+        fprintf(stderr, "Invalid process %ld in the workload\n", cursor->next);
+        cursor->next = workload->count;
+        cursor->stats->invalidInput = 1;
+        return;
+    }
+    cursor->next++;
+    enqueue(allProcesses, process);
+}
+
+// Take the earliest queued arrival and create the one after it
+static Process* takeArrival(Queue *allProcesses, WorkloadCursor *cursor) {
+    Process *process = dequeue(allProcesses);
+    refillArrivals(allProcesses, cursor);
+    return process;
+}
+
+void runRoundRobinScheduling(Queue *allProcesses, Queue *readyQueue, int quantum, MemoryStrategy strategy, const Workload *workload, FILE *output, SchedulerStats *stats) {
+    WorkloadCursor cursor = {workload, 0, stats};
+    refillArrivals(allProcesses, &cursor);
+
+    // Handling task 3 and 4
+    if (strategy == VIRTUAL || strategy == PAGED) {
+        int simulationTime = 0;
+        Process *currentProcess = NULL;
+        int totalServiceTime = 0;
+        int numberOfProcesses = 0;
+        double maxTimeOverhead = 0;
+        double totTimeOverhead = 0;
+        bool continuousRunning = false;
+        FrameTable frameTable;
+        initializeFrames(&frameTable, output);
+
+
+        while (!isQueueEmpty(allProcesses) || !isQueueEmpty(readyQueue) || currentProcess != NULL) {
+            // Check for new arrivals and move them to the ready queue or set as current process
+            PROFILE_BEGIN(PHASE_ARRIVAL);
+            while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
+                Process *newProcess = takeArrival(allProcesses, &cursor);
+
+                if (currentProcess) {
+                    enqueue(readyQueue, newProcess);
+                    continue;
+                }
+
+                // If new process is not allocated before, allocate them
+                if (!newProcess->isAllocated) {
+                    PROFILE_BEGIN(PHASE_ALLOCATION);
+                    if (strategy == PAGED) {
+                        allocatePages(&frameTable, newProcess, simulationTime);
+                    } else if (strategy == VIRTUAL) {
+                        allocateVirtualPages(&frameTable, newProcess, simulationTime);
+                    }
+                    PROFILE_END();
+                    
+                    newProcess->isAllocated = true;
+                    currentProcess = newProcess;
+                }
+                
+            }
+            PROFILE_END();
+
+            // Fetch the next process to run if there isn't a current process
+            PROFILE_BEGIN(PHASE_DISPATCH);
+            if (!currentProcess && !isQueueEmpty(readyQueue)) {
+                currentProcess = dequeue(readyQueue);
+                
+            }
+
+            if(currentProcess && !currentProcess->isAllocated) {
+
+                PROFILE_BEGIN(PHASE_ALLOCATION);
+                if (strategy == PAGED) {
+                    allocatePages(&frameTable, currentProcess, simulationTime);
+                } else if (strategy == VIRTUAL) {
+                    allocateVirtualPages(&frameTable, currentProcess, simulationTime);
+                }
+                PROFILE_END();
+                currentProcess->isAllocated = true;
+            }
+            PROFILE_END();
+
+            // Execute the current process
+            if (currentProcess) {
+                int runTime = min(quantum, currentProcess->remainingTime);
+                if (currentProcess->firstRunTime < 0) {
+                    currentProcess->firstRunTime = simulationTime;
+                }
+                if (!continuousRunning) {
+                    printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,", 
+                    simulationTime, 
+                    currentProcess->name, 
+                    currentProcess->remainingTime, 
+                    (int)calculateMemoryUsage(&frameTable));  
+                    // Call the function and cast the result to int
+                    printMemoryFrames(output, currentProcess);
+                    currentProcess->lastUsed = simulationTime;
+                } else {
+                    currentProcess->lastUsed = simulationTime;
+                }
+                
+                currentProcess->remainingTime -= runTime;
+                simulationTime += quantum;  
+
+                // Check for new arrivals and move them to the ready queue or set as current process
+                PROFILE_BEGIN(PHASE_ARRIVAL);
+                while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
+                    Process *newProcess = takeArrival(allProcesses, &cursor);
+
+                    if (currentProcess) {
+                
+                        enqueue(readyQueue, newProcess);
+                        continue;
+                    }
+
+                    if (!newProcess->isAllocated) {
+                        PROFILE_BEGIN(PHASE_ALLOCATION);
+                        if (strategy == PAGED) {
+                            allocatePages(&frameTable, newProcess, simulationTime);
+                        } else if (strategy == VIRTUAL) {
+                            allocateVirtualPages(&frameTable, newProcess, simulationTime);
+                        }
+                        PROFILE_END();
+                        
+                        newProcess->isAllocated = true;
+                        currentProcess = newProcess;
+                    }
+                    
+                }
+                PROFILE_END();
+
+                // Check if the process has finished
+                if (currentProcess->remainingTime <= 0) {
+                    PROFILE_BEGIN(PHASE_ALLOCATION);
+                    deallocatePages(&frameTable, currentProcess, simulationTime);
+                    PROFILE_END();
+                    currentProcess->isAllocated = false;
+                    printEvent(output, "%d,FINISHED,process-name=%s,proc-remaining=%d\n", simulationTime, currentProcess->name, readyQueue->count);
+                    numberOfProcesses++;
+                    currentProcess->completionTime = simulationTime;
+                    currentProcess->turnaroundTime = currentProcess->completionTime - currentProcess->arrivalTime;
+                    totalServiceTime += currentProcess->turnaroundTime;
+                    currentProcess->timeOverhead = currentProcess->turnaroundTime / (double)currentProcess->serviceTime;
+                    totTimeOverhead += currentProcess->timeOverhead;
+
+                    if (currentProcess->timeOverhead > maxTimeOverhead) {
+                        maxTimeOverhead = currentProcess->timeOverhead;
+                    }
+                    recordLatencies(stats, currentProcess);
+
+                    continuousRunning = false;
+                    // Deallocate memory when process finishes
+                    freeProcess(currentProcess);
+                    // Clear current process
+                    currentProcess = NULL;  
+                  // If process that was running still has remaining time
+                } else {
+                    if (isQueueEmpty(readyQueue)) {
+                        continuousRunning = true;
+                    } else {
+                        continuousRunning = false;
+                        // Re-queue if not finished
+                        enqueue(readyQueue, currentProcess);  
+                        currentProcess = NULL;
+                    }   
+                    
+                }
+               
+            } else {
+                simulationTime += quantum;  
+            }
+        }
+
+        // Task 5 implemenation to calculate the statistics
+        stats->simulationTime = simulationTime;
+        stats->numberOfProcesses = numberOfProcesses;
+        stats->totalTurnaroundTime = totalServiceTime;
+        stats->totTimeOverhead = totTimeOverhead;
+        stats->maxTimeOverhead = maxTimeOverhead;
+
+      // Logic and implementation for task 1 and 2   
+    } else if (strategy == INFINITE || strategy == FIRST_FIT) {
+
+         int simulationTime = 0;
+        Process *currentProcess = NULL;
+        MemoryManager *memoryManager = NULL;
+        const int totalMemory = 2048;
+        int memoryUsed = 0;
+        
+
+        int totalServiceTime = 0;
+        int numberOfProcesses = 0;
+        double maxTimeOverhead = 0;
+        double totTimeOverhead = 0;
+
+        if (strategy == FIRST_FIT) {
+            memoryManager = createContiguousMemory(totalMemory);
+        }
+        
+
+        while (!isQueueEmpty(allProcesses) || !isQueueEmpty(readyQueue) || currentProcess != NULL) {
+
+            // Check for new arrivals and move them to the ready queue or set as current process
+            PROFILE_BEGIN(PHASE_ARRIVAL);
+            while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
+                
+                if (strategy == INFINITE) {
+                    Process *newProcess = takeArrival(allProcesses, &cursor);
+                    if (isQueueEmpty(readyQueue) && !currentProcess) {
+                        currentProcess = newProcess;
+                        printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
+                    } else if (isQueueEmpty(readyQueue) && currentProcess && newProcess->arrivalTime != currentProcess->arrivalTime) {
+                        enqueue(readyQueue, currentProcess);
+                        currentProcess = newProcess;
+                        printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
+                    } else {
+                        enqueue(readyQueue, newProcess);
+                    }
+                } else if (strategy == FIRST_FIT) {
+                    Process *temp = takeArrival(allProcesses, &cursor);
+
+                    PROFILE_BEGIN(PHASE_ALLOCATION);
+                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
+                    PROFILE_END();
+
+                    // If the allocation from allProcesses is not successful, just enqueue to the ready queue and continue
+                    if (address == -1) {
+                        enqueue(readyQueue, temp);
+                        // Skip scheduling this process, keep it for later attempt
+                        continue; 
+                    } 
+
+
+                    temp->memoryAddress = address;
+                    memoryUsed += temp->memoryRequirement;
+
+
+                    // Run process again if ready queue is empty and there is no process that is running
+                    if (isQueueEmpty(readyQueue) && !currentProcess) {
+                        currentProcess = temp;
+                        printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
+                        simulationTime, 
+                        currentProcess->name, 
+                        currentProcess->remainingTime,
+                        (memoryUsed * 100 + totalMemory - 1) / totalMemory,
+                        currentProcess->memoryAddress);
+                    
+                    // Ensure that there is only one process that is running
+                    } else if (isQueueEmpty(readyQueue) && currentProcess && temp->arrivalTime != currentProcess->arrivalTime) {
+                        enqueue(readyQueue, currentProcess);
+                        currentProcess = temp;
+                        printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
+                        simulationTime, 
+                        currentProcess->name, 
+                        currentProcess->remainingTime,
+                        (memoryUsed * 100 + totalMemory - 1) / totalMemory,
+                        currentProcess->memoryAddress);
+                    } else {
+                        enqueue(readyQueue, temp);
+                    }
+
+                }
+            }
+            PROFILE_END();
+
+        
+            // Update the information of the process that is running
+            if (currentProcess) {
+                int runTime = min(quantum, currentProcess->remainingTime);
+                if (currentProcess->firstRunTime < 0) {
+                    currentProcess->firstRunTime = simulationTime;
+                }
+                currentProcess->remainingTime -= runTime;
+                simulationTime += quantum;
+
+                if (currentProcess->remainingTime > 0) {
+                    if (!isQueueEmpty(readyQueue)) {
+
+                        
+                        // Check for new arrivals and move them to the ready queue or set as current process
+                        PROFILE_BEGIN(PHASE_ARRIVAL);
+                        while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
+                            
+                            if (strategy == INFINITE) {
+                                Process *newProcess = takeArrival(allProcesses, &cursor);
+                                if (isQueueEmpty(readyQueue) && !currentProcess) {
+                                    currentProcess = newProcess;
+                                    printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
+                                } else if (isQueueEmpty(readyQueue) && currentProcess && newProcess->arrivalTime != currentProcess->arrivalTime) {
+                                    enqueue(readyQueue, currentProcess);
+                                    currentProcess = newProcess;
+                                    printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
+                                } else {
+                                    enqueue(readyQueue, newProcess);
+                                }
+                            } else if (strategy == FIRST_FIT) {
+
+                                Process *temp = takeArrival(allProcesses, &cursor);
+
+                                if (isQueueEmpty(readyQueue) && !currentProcess) {
+      
+                                    PROFILE_BEGIN(PHASE_ALLOCATION);
+                                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
+                                    PROFILE_END();
+                                    if (address == -1) {
+                                        printEvent(output, "%d, WAITING, process-name=%s, reason=Memory Allocation Failed\n", simulationTime, temp->name);
+                                        // Skip scheduling this process, keep it for later attempt
+                                        continue; 
+                                    } 
+
+                                    temp->memoryAddress = address;
+                                    memoryUsed += temp->memoryRequirement;
+
+                                    currentProcess = temp;
+                                    printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
+                                    simulationTime, 
+                                    currentProcess->name, 
+                                    currentProcess->remainingTime,
+                                    (memoryUsed * 100 + totalMemory - 1) / totalMemory,
+                                    currentProcess->memoryAddress);
+                                  // Ensure only one process is running
+                                } else if (isQueueEmpty(readyQueue) && currentProcess && temp->arrivalTime != currentProcess->arrivalTime) {
+                                    
+                                    PROFILE_BEGIN(PHASE_ALLOCATION);
+                                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
+                                    PROFILE_END();
+                                    if (address == -1) {
+                                        enqueue(readyQueue, temp);
+                                        continue; 
+                                    } 
+
+                                    temp->memoryAddress = address;
+                                    memoryUsed += temp->memoryRequirement;
+
+                                    enqueue(readyQueue, currentProcess);
+                                    currentProcess = temp;
+                                    printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
+                                    simulationTime, 
+                                    currentProcess->name, 
+                                    currentProcess->remainingTime,
+                                    (memoryUsed * 100) / totalMemory,
+                                    currentProcess->memoryAddress);
+                                } else {
+                                    
+                                    enqueue(readyQueue, temp);
+                        
+                                
+                                }
+
+                            }
+                        }
+                        PROFILE_END();
+
+                        enqueue(readyQueue, currentProcess);
+                        // Clear currentProcess to pick the next available process
+                        currentProcess = NULL; 
+                    }
+                } else {
+
+                    // Update for task 5 statistics 
+                    numberOfProcesses++;
+                    currentProcess->completionTime = simulationTime;
+                    currentProcess->turnaroundTime = currentProcess->completionTime - currentProcess->arrivalTime;
+                    totalServiceTime += currentProcess->turnaroundTime;
+                    currentProcess->timeOverhead = currentProcess->turnaroundTime / currentProcess->serviceTime;
+                    totTimeOverhead += currentProcess->timeOverhead;
+
+                    if (currentProcess->timeOverhead > maxTimeOverhead) {
+                        maxTimeOverhead = currentProcess->timeOverhead;
+                    }
+                    recordLatencies(stats, currentProcess);
+
+                    if (memoryManager) {
+                        PROFILE_BEGIN(PHASE_ALLOCATION);
+                        deallocateMemory(memoryManager, currentProcess->memoryAddress, currentProcess->memoryRequirement);
+                        PROFILE_END();
+                        memoryUsed -= currentProcess->memoryRequirement;
+                    }
+                    // Arrivals at the instant it finishes queue for the next dispatch, the
+                    // finished process must not be put back in the ready queue
+                    PROFILE_BEGIN(PHASE_ARRIVAL);
+                    while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
+                        enqueue(readyQueue, takeArrival(allProcesses, &cursor));
+                    }
+                    PROFILE_END();
+                    
+                    printEvent(output, "%d,FINISHED,process-name=%s,proc-remaining=%d\n", simulationTime, currentProcess->name, readyQueue->count);
+                    
+                    // Assuming memory management is required
+                    freeProcess(currentProcess); 
+                    currentProcess = NULL;
+                }
+                
+            } 
+            
+            else {
+                simulationTime += quantum;
+            }
+
+            // Dequeue to ready queue when a process finishes running
+            PROFILE_BEGIN(PHASE_DISPATCH);
+            if (!currentProcess && !isQueueEmpty(readyQueue) && strategy == INFINITE) {
+                currentProcess = dequeue(readyQueue);
+                printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
+
+
+            } else if(!currentProcess && !isQueueEmpty(readyQueue) && strategy == FIRST_FIT) {
+
+                // Iterate until a process with allocated is found    
+                while(!isQueueEmpty(readyQueue)) {
+                    Process *temp = dequeue(readyQueue);
+                    if(temp->memoryAddress == -1) {
+                        PROFILE_BEGIN(PHASE_ALLOCATION);
+                        int address = allocateMemory(memoryManager, temp->memoryRequirement);
+                        PROFILE_END();
+                        if (address == -1) {
+                            enqueue(readyQueue, temp);
+                            // Skip scheduling this process, keep it for later attempt
+                            continue; 
+                        } else {
+                            temp->memoryAddress = address;
+                            memoryUsed += temp->memoryRequirement;
+                            currentProcess = temp;
+                            break;
+                        }
+
+                        
+                    } else {
+                        currentProcess = temp;
+                        break;
+                    }
+                }
+
+                printEvent(output, "%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n",
+                    simulationTime,
+                    currentProcess->name,
+                    currentProcess->remainingTime,
+                    (memoryUsed * 100 + totalMemory - 1) / totalMemory,
+                    currentProcess->memoryAddress);
+            }
+            PROFILE_END();
+        }
+        // Statistics for task 5
+        stats->simulationTime = simulationTime;
+        stats->numberOfProcesses = numberOfProcesses;
+        stats->totalTurnaroundTime = totalServiceTime;
+        stats->totTimeOverhead = totTimeOverhead;
+        stats->maxTimeOverhead = maxTimeOverhead;
+    }
+
+
+    }
+
+// Finding the minimum
+int min(int x, int y) {
+    return x < y ? x : y;
+}
+
+// Print running of a process
+void printProcessStats(Process *process, int simulationTime) {
+    printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, process->name, process->remainingTime);
+}
+
+
@@ -0,0 +1,14 @@
+#ifndef ROUND_ROBIN_H
+#define ROUND_ROBIN_H
+
+#include <stdio.h>
+
+#include "Queue.h"
+#include "Scheduler.h"
+#include "Workload.h"
+
+void runRoundRobinScheduling(Queue *allProcesses, Queue *readyQueue, int quantum, MemoryStrategy strategy, const Workload *workload, FILE *output, SchedulerStats *stats);
+void printProcessStats(Process *process, int simulationTime);
+int min(int x, int y);
+
+#endif
@@ -0,0 +1,645 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Scheduler.h"
+#include "RoundRobin.h"
+#include "Simulation.h"
+#include "FeedbackQueue.h"
+#include "PagedMemory.h"
+
+void initializeMemoryState(MemoryState *memory, MemoryStrategy strategy, FILE *output) {
+    memory->strategy = strategy;
+    memory->memoryManager = NULL;
+    memory->memoryUsed = 0;
+    memory->demandPaging = false;
+    memory->output = output;
+    memory->swapPolicy = SWAP_NONE;
+    memory->resident = NULL;
+    memory->residentCount = 0;
+    memory->residentCapacity = 0;
+    memory->processSwapOuts = 0;
+    memory->processSwapIns = 0;
+    memory->swappedOutKB = 0;
+    memory->swappedInKB = 0;
+    memory->numaNodes = 1;
+    memory->preferredNode = 0;
+    memory->interleave = false;
+    memory->nextNode = 0;
+    memory->pagesMigrated = 0;
+    memory->printHealth = false;
+    memory->admissionFailures = 0;
+    memory->fragmentedFailures = 0;
+    memory->worstFragmentation = 0.0;
+    for (int i = 0; i < MAX_NUMA_NODES; i++) {
+        memory->nodeUsedKB[i] = 0;
+        memory->nodePeakKB[i] = 0;
+    }
+
+    if (strategy == FIRST_FIT) {
+        memory->memoryManager = createContiguousMemory(TOTAL_MEMORY);
+    } else if (strategy == PAGED || strategy == VIRTUAL) {
+        initializeFrames(&memory->frameTable, output);
+    }
+}
+
+void freeMemoryState(MemoryState *memory) {
+    free(memory->resident);
+    memory->resident = NULL;
+    if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        freeFrameTable(&memory->frameTable);
+    }
+    if (!memory->memoryManager) {
+        return;
+    }
+    freeContiguousMemory(memory->memoryManager);
+    memory->memoryManager = NULL;
+}
+
+static void addResident(MemoryState *memory, Process *process) {
+    if (memory->residentCount == memory->residentCapacity) {
+        int capacity = memory->residentCapacity ? 2 * memory->residentCapacity : 16;
+        Process **grown = (Process **)realloc(memory->resident, capacity * sizeof(Process *));
+        if (!grown) {
+            // Untracked processes are simply never picked to swap out
+            return;
+        }
+        memory->resident = grown;
+        memory->residentCapacity = capacity;
+    }
+    memory->resident[memory->residentCount++] = process;
+}
+
+static void removeResident(MemoryState *memory, Process *process) {
+    for (int i = 0; i < memory->residentCount; i++) {
+        if (memory->resident[i] == process) {
+            memory->resident[i] = memory->resident[--memory->residentCount];
+            return;
+        }
+    }
+}
+
+// Resident process the medium-term scheduler would swap out to make room for process
+static Process* chooseSwapVictim(MemoryState *memory, Process *process) {
+    Process *victim = NULL;
+    for (int i = 0; i < memory->residentCount; i++) {
+        Process *candidate = memory->resident[i];
+        if (candidate == process || candidate->state == RUNNING || candidate->state == BLOCKED) {
+            continue;
+        }
+        if (!victim ||
+            (memory->swapPolicy == SWAP_LARGEST && candidate->memoryRequirement > victim->memoryRequirement) ||
+            ((memory->swapPolicy == SWAP_LRU || candidate->memoryRequirement == victim->memoryRequirement) &&
+             candidate->lastUsed < victim->lastUsed)) {
+            victim = candidate;
+        }
+    }
+    return victim;
+}
+
+static int compareAddresses(const void *a, const void *b) {
+    return (*(Process * const *)a)->memoryAddress - (*(Process * const *)b)->memoryAddress;
+}
+
+// Whether swapping out every candidate victim would leave a hole for process. Without
+// this check a load could swap others out and still fail, only to swap them back in
+static int fitsAfterSwapping(MemoryState *memory, Process *process) {
+    Process **pinned = (Process **)malloc((memory->residentCount + 1) * sizeof(Process *));
+    if (!pinned) {
+        return 0;
+    }
+    int count = 0;
+    for (int i = 0; i < memory->residentCount; i++) {
+        Process *candidate = memory->resident[i];
+        if (candidate->state == RUNNING || candidate->state == BLOCKED) {
+            pinned[count++] = candidate;
+        }
+    }
+    qsort(pinned, count, sizeof(Process *), compareAddresses);
+    int start = 0;
+    int fits = 0;
+    for (int i = 0; i <= count && !fits; i++) {
+        int end = i < count ? pinned[i]->memoryAddress : TOTAL_MEMORY;
+        fits = end - start >= process->memoryRequirement;
+        if (i < count) {
+            start = pinned[i]->memoryAddress + pinned[i]->memoryRequirement;
+        }
+    }
+    free(pinned);
+    return fits;
+}
+
+// First KB of node, contiguous memory is split evenly and in order
+static int nodeStartKB(MemoryState *memory, int node) {
+    return (node * TOTAL_MEMORY + memory->numaNodes - 1) / memory->numaNodes;
+}
+
+// KB of the first-fit block at address of size on node
+static int blockOnNode(MemoryState *memory, int address, int size, int node) {
+    int start = nodeStartKB(memory, node);
+    int end = nodeStartKB(memory, node + 1);
+    if (address > start) start = address;
+    if (address + size < end) end = address + size;
+    return end > start ? end - start : 0;
+}
+
+// Add or, with a negative sign, take a first-fit block off the usage of the nodes it covers
+static void chargeNodes(MemoryState *memory, int address, int size, int sign) {
+    for (int node = 0; memory->numaNodes > 1 && node < memory->numaNodes; node++) {
+        memory->nodeUsedKB[node] += sign * blockOnNode(memory, address, size, node);
+        if (memory->nodeUsedKB[node] > memory->nodePeakKB[node]) {
+            memory->nodePeakKB[node] = memory->nodeUsedKB[node];
+        }
+    }
+}
+
+// First fit on the preferred node, or the next one in turn with interleave, then on the
+// others. A block no node has room for may span nodes
+static int allocateOnNodes(MemoryState *memory, int size) {
+    if (memory->numaNodes <= 1) {
+        return allocateMemory(memory->memoryManager, size);
+    }
+    int first = memory->preferredNode;
+    if (memory->interleave) {
+        first = memory->nextNode;
+        memory->nextNode = (memory->nextNode + 1) % memory->numaNodes;
+    }
+    for (int i = 0; i < memory->numaNodes; i++) {
+        int node = (first + i) % memory->numaNodes;
+        int address = allocateMemoryInRange(memory->memoryManager, size, nodeStartKB(memory, node), nodeStartKB(memory, node + 1));
+        if (address != -1) {
+            return address;
+        }
+    }
+    return allocateMemory(memory->memoryManager, size);
+}
+
+// The hole list keeps its metrics up to date, so this costs nothing per event
+static void noteFragmentation(MemoryState *memory) {
+    double fragmentation = fragmentationIndex(memory->memoryManager);
+    if (fragmentation > memory->worstFragmentation) {
+        memory->worstFragmentation = fragmentation;
+    }
+}
+
+// Move a whole first-fit process to the backing store, freeing its hole
+static void swapOutWholeProcess(MemoryState *memory, Process *process, int simulationTime) {
+    printEvent(memory->output, "%d,SWAPPED-OUT,process-name=%s,freed-at=%d,size=%dKB\n",
+               simulationTime, process->name, process->memoryAddress, process->memoryRequirement);
+    deallocateMemory(memory->memoryManager, process->memoryAddress, process->memoryRequirement);
+    chargeNodes(memory, process->memoryAddress, process->memoryRequirement, -1);
+    memory->memoryUsed -= process->memoryRequirement;
+    memory->swappedOutKB += process->memoryRequirement;
+    memory->processSwapOuts++;
+    removeResident(memory, process);
+    process->memoryAddress = -1;
+    process->isAllocated = false;
+    process->swappedPages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+}
+
+// Make sure a process is resident before it runs. Return 0 if it can run, -1 if
+// first-fit could not find a hole large enough for it
+int loadProcess(MemoryState *memory, Process *process, int simulationTime) {
+    if (memory->strategy == FIRST_FIT) {
+        if (process->memoryAddress == -1) {
+            int address = allocateOnNodes(memory, process->memoryRequirement);
+            // Swap out whole processes until a hole fits, unless nothing could
+            if (address == -1 && memory->swapPolicy != SWAP_NONE && fitsAfterSwapping(memory, process)) {
+                Process *victim;
+                while (address == -1 && (victim = chooseSwapVictim(memory, process))) {
+                    swapOutWholeProcess(memory, victim, simulationTime);
+                    address = allocateOnNodes(memory, process->memoryRequirement);
+                }
+            }
+            noteFragmentation(memory);
+            if (address == -1) {
+                memory->admissionFailures++;
+                if (memory->memoryManager->freeMemory >= process->memoryRequirement) {
+                    memory->fragmentedFailures++;
+                }
+                return -1;
+            }
+            process->memoryAddress = address;
+            chargeNodes(memory, address, process->memoryRequirement, 1);
+            memory->memoryUsed += process->memoryRequirement;
+            if (memory->swapPolicy != SWAP_NONE) {
+                addResident(memory, process);
+            }
+            if (process->swappedPages > 0) {
+                memory->swappedInKB += process->memoryRequirement;
+                memory->processSwapIns++;
+                process->swappedPages = 0;
+            }
+            process->isAllocated = true;
+        }
+    } else if (memory->strategy == VIRTUAL && memory->demandPaging) {
+        // Pages fault in as the process references them, it only needs a page table
+        if (!process->frameAllocations) {
+            int pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+            process->frameAllocations = (int *)malloc((pages > 0 ? pages : 1) * sizeof(int));
+            if (!process->frameAllocations) {
+                return -1;
+            }
+            for (int i = 0; i < pages; i++) {
+                process->frameAllocations[i] = -1;
+            }
+        }
+        process->isAllocated = true;
+    } else if (!process->isAllocated) {
+        memory->frameTable.preferredNode = memory->preferredNode;
+        // Allocation only fails when every other resident process is running on another core
+        if ((memory->strategy == PAGED && allocatePages(&memory->frameTable, process, simulationTime) != 0) ||
+            (memory->strategy == VIRTUAL && allocateVirtualPages(&memory->frameTable, process, simulationTime) != 0)) {
+            memory->admissionFailures++;
+            return -1;
+        }
+        process->isAllocated = true;
+    }
+    return 0;
+}
+
+// Give back the memory of a finished process
+void releaseProcess(MemoryState *memory, Process *process, int simulationTime) {
+    if (memory->strategy == FIRST_FIT) {
+        deallocateMemory(memory->memoryManager, process->memoryAddress, process->memoryRequirement);
+        chargeNodes(memory, process->memoryAddress, process->memoryRequirement, -1);
+        memory->memoryUsed -= process->memoryRequirement;
+        process->memoryAddress = -1;
+        removeResident(memory, process);
+        noteFragmentation(memory);
+    } else if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        deallocatePages(&memory->frameTable, process, simulationTime);
+        process->frameAllocations = NULL;
+    }
+    process->isAllocated = false;
+}
+
+// Move the memory of a resident process to node. A first-fit block moves only as a whole
+// and only if a hole on node fits it. Return the number of pages moved
+int migrateProcess(MemoryState *memory, Process *process, int node) {
+    if (memory->numaNodes <= 1 || !process->isAllocated) {
+        return 0;
+    }
+    if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        return migratePages(&memory->frameTable, process, node);
+    }
+    if (memory->strategy != FIRST_FIT || process->memoryAddress == -1 ||
+        blockOnNode(memory, process->memoryAddress, process->memoryRequirement, node) == process->memoryRequirement) {
+        return 0;
+    }
+    int address = allocateMemoryInRange(memory->memoryManager, process->memoryRequirement, nodeStartKB(memory, node),
+                                        nodeStartKB(memory, node + 1));
+    if (address == -1) {
+        return 0;
+    }
+    deallocateMemory(memory->memoryManager, process->memoryAddress, process->memoryRequirement);
+    chargeNodes(memory, process->memoryAddress, process->memoryRequirement, -1);
+    chargeNodes(memory, address, process->memoryRequirement, 1);
+    process->memoryAddress = address;
+    int pages = (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE;
+    memory->pagesMigrated += pages;
+    return pages;
+}
+
+// KB of the memory of a first-fit process that lies on node
+int memoryOnNode(MemoryState *memory, Process *process, int node) {
+    if (memory->strategy != FIRST_FIT || process->memoryAddress == -1) {
+        return 0;
+    }
+    if (memory->numaNodes <= 1) {
+        return process->memoryRequirement;
+    }
+    return blockOnNode(memory, process->memoryAddress, process->memoryRequirement, node);
+}
+
+// Print the cpu field of an event, cpu is -1 on a single core
+static void printCpuField(FILE *output, int cpu) {
+    if (cpu >= 0) {
+        printEvent(output, "cpu=%d,", cpu);
+    }
+}
+
+// Print a RUNNING event in the same format as the round robin scheduler
+void printRunningEvent(FILE *output, MemoryState *memory, Process *process, int simulationTime, int cpu) {
+    printEvent(output, "%d,RUNNING,", simulationTime);
+    printCpuField(output, cpu);
+    if (memory->strategy == FIRST_FIT) {
+        printEvent(output, "process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d",
+            process->name,
+            process->remainingTime,
+            (memory->memoryUsed * 100 + TOTAL_MEMORY - 1) / TOTAL_MEMORY,
+            process->memoryAddress);
+        if (memory->printHealth) {
+            MemoryManager *manager = memory->memoryManager;
+            printEvent(output, ",holes=%d,largest-hole=%dKB,fragmentation=%.2f", manager->holeCount,
+                       manager->largestHole, fragmentationIndex(manager));
+        }
+        printEvent(output, "\n");
+    } else if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        printEvent(output, "process-name=%s,remaining-time=%d,mem-usage=%d%%,",
+            process->name,
+            process->remainingTime,
+            calculateMemoryUsage(&memory->frameTable));
+        if (memory->printHealth) {
+            FrameTable *table = &memory->frameTable;
+            printEvent(output, "resident=%d,evicted=%ld,faults=%ld,", table->framesUsed, table->framesSwappedOut,
+                       table->pageFaults);
+        }
+        printMemoryFrames(output, process);
+    } else {
+        printEvent(output, "process-name=%s,remaining-time=%d\n", process->name, process->remainingTime);
+    }
+}
+
+void printFinishedEvent(FILE *output, Process *process, int simulationTime, int procRemaining, int cpu) {
+    printEvent(output, "%d,FINISHED,", simulationTime);
+    printCpuField(output, cpu);
+    printEvent(output, "process-name=%s,proc-remaining=%d\n", process->name, procRemaining);
+}
+
+void recordFinishedProcess(SchedulerStats *stats, Process *process) {
+    process->completionTime = stats->simulationTime;
+    process->turnaroundTime = process->completionTime - process->arrivalTime;
+    process->timeOverhead = process->turnaroundTime / (double)process->serviceTime;
+
+    stats->numberOfProcesses++;
+    stats->totalTurnaroundTime += process->turnaroundTime;
+    stats->totTimeOverhead += process->timeOverhead;
+    if (process->timeOverhead > stats->maxTimeOverhead) {
+        stats->maxTimeOverhead = process->timeOverhead;
+    }
+    if (process->memoryGroup >= 0) {
+        stats->groups[process->memoryGroup].finished++;
+        stats->groups[process->memoryGroup].totalTurnaroundTime += process->turnaroundTime;
+    }
+    recordLatencies(stats, process);
+}
+
+// Add a finished process to the latency histograms, once its turnaround and overhead are set
+void recordLatencies(SchedulerStats *stats, Process *process) {
+    recordValue(&stats->turnaroundHistogram, (int)process->turnaroundTime);
+    recordValue(&stats->waitingHistogram, (int)process->turnaroundTime - process->serviceTime);
+    if (process->firstRunTime >= 0) {
+        recordValue(&stats->responseHistogram, process->firstRunTime - process->arrivalTime);
+    }
+    recordValue(&stats->overheadHistogram, (int)(process->timeOverhead * 100.0 + 0.5));
+}
+
+// Average turnaround time, rounded up
+int averageTurnaroundTime(SchedulerStats *stats) {
+    double averageTurnaroundTime = stats->totalTurnaroundTime / stats->numberOfProcesses;
+    return (int)(averageTurnaroundTime + 0.999999);
+}
+
+// Average time overhead, rounded to two decimals
+double averageTimeOverhead(SchedulerStats *stats) {
+    double timeOverheadCalculation = (stats->totTimeOverhead / stats->numberOfProcesses) * 100.0;
+    return (int)(timeOverheadCalculation + 0.5) / 100.0;
+}
+
+// Task 5 statistics, rounded the same way as the round robin scheduler
+void printStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Turnaround time %d\n", averageTurnaroundTime(stats));
+    printEvent(output, "Time overhead %.2f %.2f\n", stats->maxTimeOverhead, averageTimeOverhead(stats));
+    printEvent(output, "Makespan %d\n", stats->simulationTime);
+}
+
+void initializeSchedulerOptions(SchedulerOptions *options) {
+    options->policy = ROUND_ROBIN;
+    options->feedbackLevels = FEEDBACK_DEFAULT_LEVELS;
+    options->boostInterval = 0;
+    options->cores = 1;
+    options->output = stdout;
+    options->switchCost = -1;
+    options->warmthPenalty = 0;
+    options->warmthDecay = 0;
+    options->swapBandwidth = 0;
+    options->swapLatency = 0;
+    options->swapQueueDepth = 1;
+    options->reclaimLowWatermark = 0;
+    options->reclaimHighWatermark = 0;
+    options->tlbEntries = 0;
+    options->tlbWays = 4;
+    options->tlbReplacement = TLB_LRU;
+    options->tlbTagged = false;
+    options->tlbMissPenalty = 20;
+    options->pageReferences = 100;
+    options->demandPaging = false;
+    options->faultPenalty = 1000;
+    options->workingSetWindow = 0;
+    options->loadControl = false;
+    options->processSwapPolicy = SWAP_NONE;
+    options->cowWritePercent = 0;
+    options->hugePageFrames = 0;
+    options->numaNodes = 1;
+    options->numaPolicy = NUMA_LOCAL;
+    options->numaRemotePenalty = 100;
+    options->numaMigrateCost = 1000;
+    options->memoryHealth = false;
+    options->profile = false;
+    options->tracePath = NULL;
+    options->latencyPercentiles = false;
+    options->checkpointPath = NULL;
+    options->checkpointTime = -1;
+    options->checkpointEvents = 0;
+    options->checkpointStop = false;
+    options->restorePath = NULL;
+    options->workload = NULL;
+}
+
+// Also true for -x 0, which counts free switches in the same loop a nonzero cost runs in,
+// so comparing the two shows the switch overhead alone
+int hasSwitchCost(SchedulerOptions *options) {
+    return options->switchCost >= 0 || options->warmthPenalty > 0;
+}
+
+// Cost of switching a core to process. The cache penalty grows with the time the
+// process spent off the CPU, reaching half of warmthPenalty after warmthDecay, and is
+// paid in full by a process that never ran on this core
+int contextSwitchCost(SchedulerOptions *options, Process *process, int cpu, int simulationTime) {
+    int cost = options->switchCost > 0 ? options->switchCost : 0;
+    if (options->warmthPenalty <= 0) {
+        return cost;
+    }
+    if (process->lastCpu != cpu) {
+        return cost + options->warmthPenalty;
+    }
+    long elapsed = simulationTime - process->lastUsed;
+    long decay = options->warmthDecay > 0 ? options->warmthDecay : 1;
+    return cost + (int)(options->warmthPenalty * elapsed / (elapsed + decay));
+}
+
+void printSwitchStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Context switches %d overhead %ld\n", stats->contextSwitches, stats->switchOverhead);
+}
+
+int hasSwapDevice(SchedulerOptions *options) {
+    return options->swapBandwidth > 0;
+}
+
+void printSwapStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Swapped in %ldKB out %ldKB blocked %ld\n", stats->swappedIn, stats->swappedOut, stats->swapWaitTime);
+}
+
+int hasBackgroundReclaim(SchedulerOptions *options) {
+    return options->reclaimLowWatermark > 0;
+}
+
+void printReclaimStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Reclaim direct %d background %d frames %ld\n", stats->directReclaims, stats->backgroundReclaims, stats->backgroundFrames);
+}
+
+int hasTlb(SchedulerOptions *options) {
+    return options->tlbEntries > 0;
+}
+
+void printTlbStatistics(FILE *output, SchedulerStats *stats) {
+    long lookups = stats->tlbHits + stats->tlbMisses;
+    double hitRate = lookups > 0 ? 100.0 * stats->tlbHits / lookups : 0.0;
+    printEvent(output, "TLB hit rate %.2f%% miss cycles %ld overhead %ld\n", hitRate, stats->tlbMissCycles, stats->tlbOverhead);
+}
+
+void printPageFaultStatistics(FILE *output, SchedulerStats *stats) {
+    double faultRate = stats->pageReferencesMade > 0 ? 100.0 * stats->pageFaults / stats->pageReferencesMade : 0.0;
+    printEvent(output, "Page faults %ld references %ld fault rate %.4f%% overhead %ld\n", stats->pageFaults,
+               stats->pageReferencesMade, faultRate, stats->faultOverhead);
+}
+
+// Eviction rates are frames per 1000 units of time, split at the first suspension
+void printWorkingSetStatistics(FILE *output, SchedulerStats *stats, bool loadControl) {
+    printEvent(output, "Working set peak %ld pages\n", stats->peakWorkingSet);
+    if (!loadControl) {
+        return;
+    }
+    int before = stats->controlStart >= 0 ? stats->controlStart : stats->simulationTime;
+    int after = stats->simulationTime - before;
+    long evictedBefore = stats->controlStart >= 0 ? stats->framesEvictedBeforeControl : stats->framesEvicted;
+    double rateBefore = before > 0 ? 1000.0 * evictedBefore / before : 0.0;
+    double rateAfter = after > 0 ? 1000.0 * (stats->framesEvicted - evictedBefore) / after : 0.0;
+    printEvent(output, "Load control suspensions %d resumptions %d eviction rate before %.2f after %.2f\n",
+               stats->suspensions, stats->resumptions, rateBefore, rateAfter);
+}
+
+void printProcessSwapStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Process swaps out %d %ldKB in %d %ldKB\n", stats->processSwapOuts, stats->processSwappedOutKB,
+               stats->processSwapIns, stats->processSwappedInKB);
+}
+
+void printSharedMemoryStatistics(FILE *output, SchedulerStats *stats) {
+    printEvent(output, "Shared memory peak physical %dKB virtual %dKB shared pages %ld reused %ld cow copies %ld\n",
+               stats->peakPhysicalKB, stats->peakVirtualKB, stats->sharedPagesMapped, stats->sharedFramesReused,
+               stats->cowCopies);
+}
+
+// One line per memory group, turnaround averaged and rounded up like the overall one
+void printGroupStatistics(FILE *output, SchedulerStats *stats) {
+    for (int i = 0; i < MAX_MEMORY_GROUPS; i++) {
+        GroupStats *group = &stats->groups[i];
+        if (!group->used) {
+            continue;
+        }
+        int turnaround = group->finished ? (int)(group->totalTurnaroundTime / group->finished + 0.999999) : 0;
+        printEvent(output, "Group %d limit %dKB peak %dKB evicted %ld reclaims %d turnaround %d\n", i, group->limitKB,
+                   group->peakKB, group->framesEvicted, group->reclaims, turnaround);
+    }
+}
+
+int hasHugePages(SchedulerOptions *options) {
+    return options->hugePageFrames > 1;
+}
+
+void printHugePageStatistics(FILE *output, SchedulerStats *stats) {
+    double coverage = stats->pagesMapped > 0 ? 100.0 * stats->hugePagesMapped / stats->pagesMapped : 0.0;
+    printEvent(output, "Huge pages coverage %.2f%% waste %ldKB fallbacks %d splits %d\n", coverage,
+               stats->hugeWasteFrames * PAGE_SIZE, stats->hugeFallbacks, stats->hugeSplits);
+}
+
+int hasNuma(SchedulerOptions *options) {
+    return options->numaNodes > 1;
+}
+
+void printNumaStatistics(FILE *output, SchedulerStats *stats) {
+    long accesses = stats->numaLocalAccesses + stats->numaRemoteAccesses;
+    double localRate = accesses > 0 ? 100.0 * stats->numaLocalAccesses / accesses : 0.0;
+    printEvent(output, "NUMA local %.2f%% remote %ld overhead %ld migrated %ld node peaks", localRate,
+               stats->numaRemoteAccesses, stats->numaOverhead, stats->pagesMigrated);
+    for (int i = 0; i < stats->numaNodes; i++) {
+        printEvent(output, "%s%dKB", i ? "," : " ", stats->nodePeakKB[i]);
+    }
+    printEvent(output, "\n");
+}
+
+void printMemoryHealthStatistics(FILE *output, SchedulerStats *stats, MemoryStrategy strategy) {
+    if (strategy == FIRST_FIT) {
+        printEvent(output, "Memory health peak holes %d worst fragmentation %.2f admission failures %d fragmented %d\n",
+                   stats->peakHoleCount, stats->worstFragmentation, stats->admissionFailures, stats->fragmentedFailures);
+    } else if (strategy == PAGED || strategy == VIRTUAL) {
+        printEvent(output, "Memory health peak resident %dKB evicted %ld faults %ld admission failures %d\n",
+                   stats->peakPhysicalKB, stats->framesEvicted, stats->pageFaults, stats->admissionFailures);
+    }
+}
+
+static void printPercentiles(FILE *output, const char *name, const Histogram *histogram, double scale) {
+    static const double percents[] = {50, 90, 99, 99.9};
+    static const char *labels[] = {"p50", "p90", "p99", "p99.9"};
+    printEvent(output, "%s", name);
+    for (int i = 0; i < 4; i++) {
+        printEvent(output, " %s %.*f", labels[i], scale > 1 ? 2 : 0, histogramPercentile(histogram, percents[i]) / scale);
+    }
+    printEvent(output, " max %.*f\n", scale > 1 ? 2 : 0, histogram->max / scale);
+}
+
+// Percentiles are accurate to within 1/32 of the value, see Histogram.h
+void printLatencyStatistics(FILE *output, SchedulerStats *stats) {
+    printPercentiles(output, "Turnaround", &stats->turnaroundHistogram, 1);
+    printPercentiles(output, "Waiting", &stats->waitingHistogram, 1);
+    printPercentiles(output, "Response", &stats->responseHistogram, 1);
+    printPercentiles(output, "Time overhead", &stats->overheadHistogram, 100);
+}
+
+// Whether columns, as the input gives them, has one starting with prefix
+static int hasColumn(const char *columns, const char *prefix) {
+    for (const char *found = strstr(columns, prefix); found; found = strstr(found + 1, prefix)) {
+        if (found == columns || found[-1] == ' ' || found[-1] == '\t') {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Whether any process maps a shared segment or belongs to a memory group. A mapped
+// workload is checked on its text columns, without creating its processes
+int hasPagedExtensions(Queue *processes, const Workload *workload) {
+    for (Node *node = processes->front; node; node = node->next) {
+        if (node->data->sharedSegment >= 0 || node->data->memoryGroup >= 0) {
+            return 1;
+        }
+    }
+    for (long i = 0; workload && workload->extraColumns && i < workload->count; i++) {
+        const char *columns = workloadString(workload, workload->extraColumns[i]);
+        if (columns && (hasColumn(columns, "shared:") || hasColumn(columns, "group:"))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Run one simulation with whichever loop applies. The round robin reference loop
+// only models a single core, every other configuration goes through the policy loop,
+// which gives round robin the same schedule on one core under every memory strategy
+void runScheduling(Queue *allProcesses, int quantum, MemoryStrategy strategy, SchedulerOptions *options, SchedulerStats *stats) {
+    // The reference loop also treats context switches, swapping and translation as free,
+    // only reclaims on demand and writes no trace or checkpoint
+    if (options->policy != ROUND_ROBIN || options->cores > 1 || hasSwitchCost(options) || hasSwapDevice(options) ||
+        hasBackgroundReclaim(options) || hasTlb(options) || hasHugePages(options) || hasNuma(options) ||
+        options->demandPaging || options->workingSetWindow > 0 || options->processSwapPolicy != SWAP_NONE ||
+        options->cowWritePercent > 0 || options->memoryHealth || options->tracePath || options->checkpointPath ||
+        options->restorePath || hasPagedExtensions(allProcesses, options->workload)) {
+        runPolicyScheduling(allProcesses, quantum, strategy, options, stats);
+    } else {
+        Queue *readyQueue = createQueue();
+        memset(stats, 0, sizeof(SchedulerStats));
+        runRoundRobinScheduling(allProcesses, readyQueue, quantum, strategy, options->workload, options->output, stats);
+        freeQueue(readyQueue);
+    }
+}
@@ -0,0 +1,234 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+
+#include "Queue.h"
+#include "ContiguousMemory.h"
+#include "PagedMemory.h"
+#include "Tlb.h"
+#include "Histogram.h"
+#include "Workload.h"
+
+// Total memory available to the contiguous allocator, in KB
+#define TOTAL_MEMORY 2048
+
+// Processor cycles in one unit of simulation time, used to turn stall cycles into time
+#define CYCLES_PER_TIME_UNIT 1000
+
+// Define an enum for memory strategies
+typedef enum {
+    INFINITE,
+    FIRST_FIT,
+    PAGED,
+    VIRTUAL
+} MemoryStrategy;
+
+// Which resident process the medium-term scheduler swaps out under first-fit
+typedef enum {
+    SWAP_NONE,   // Processes that find no hole wait for one
+    SWAP_LRU,    // Swap out the least recently run process
+    SWAP_LARGEST // Swap out the process holding the most memory
+} ProcessSwapPolicy;
+
+// Where NUMA places memory and whether it follows the process
+typedef enum {
+    NUMA_LOCAL,      // Fill the node of the core the process is dispatched on first
+    NUMA_INTERLEAVE, // Spread pages, or successive first-fit blocks, over the nodes in turn
+    NUMA_MIGRATE     // Local first, and move memory to the new node when the process changes node
+} NumaPolicy;
+
+// Define an enum for scheduling policies
+typedef enum {
+    ROUND_ROBIN,
+    FAIR,
+    FEEDBACK
+} SchedulingPolicy;
+
+// Command line knobs for the scheduling policies
+typedef struct {
+    SchedulingPolicy policy; // Selected scheduling policy
+    int feedbackLevels; // Number of feedback queue levels
+    int boostInterval; // Time between feedback priority boosts, 0 picks the default
+    int cores; // Number of simulated CPUs
+    FILE *output; // Where events go, NULL to stay quiet
+    int switchCost; // Fixed cost of every context switch, -1 when switches are not modelled
+    int warmthPenalty; // Extra cost of switching to a process whose cache is completely cold
+    int warmthDecay; // Time off the CPU after which half of the cache is cold, 0 uses the quantum
+    int swapBandwidth; // KB the swap device moves per unit of time, 0 makes swapping free
+    int swapLatency; // Fixed time of every swap request
+    int swapQueueDepth; // Swap requests serviced concurrently
+    int reclaimLowWatermark; // Free frames below which background reclaim starts, 0 disables it
+    int reclaimHighWatermark; // Free frames background reclaim stops at
+    int tlbEntries; // Entries of each core's TLB, 0 disables the TLB model
+    int tlbWays; // TLB associativity
+    TlbReplacement tlbReplacement; // Victim choice within a TLB set
+    bool tlbTagged; // Tag entries with the address space instead of flushing on a switch
+    int tlbMissPenalty; // Cycles of a page walk after a TLB miss
+    int pageReferences; // Page references a process makes per unit of time
+    bool demandPaging; // Virtual memory faults pages in as they are referenced
+    int faultPenalty; // Cycles to service a page fault
+    int workingSetWindow; // References in the working set window, 0 disables tracking
+    bool loadControl; // Suspend whole processes while their working sets exceed memory
+    ProcessSwapPolicy processSwapPolicy; // Medium-term swapping of whole processes under first-fit
+    int cowWritePercent; // Percent of page references that write, splitting shared pages copy-on-write
+    int hugePageFrames; // Frames per huge page, 0 allocates base pages only
+    int numaNodes; // Memory nodes, each with an even share of memory and of the cores, 1 disables NUMA
+    NumaPolicy numaPolicy; // Placement policy across the nodes
+    int numaRemotePenalty; // Extra cycles of a reference to memory on another node
+    int numaMigrateCost; // Cycles to migrate one page to another node
+    bool memoryHealth; // Add hole or frame metrics to RUNNING events and the summary
+    bool profile; // Print hot-path counters and phase times to stderr, PROFILE builds only
+    const char *tracePath; // Chrome trace file of the run, NULL writes none
+    bool latencyPercentiles; // Add tail percentiles of the per-process times to the summary
+    const char *checkpointPath; // Where to save a checkpoint of the run, NULL saves none
+    int checkpointTime; // Save it at the first event at or after this time, -1 to count events instead
+    long checkpointEvents; // Save it after this many scheduling events
+    bool checkpointStop; // End the run once the checkpoint is saved, without a summary
+    const char *restorePath; // Checkpoint the run continues from, NULL starts at time 0
+    const Workload *workload; // Mapped input the loops create each process from as it arrives, NULL when the input is queued
+} SchedulerOptions;
+
+// Totals of one memory group
+typedef struct {
+    bool used; // Some process of the group asked for frames
+    int limitKB; // Memory limit of the group, 0 if none was given
+    int peakKB; // Most memory the group held at once
+    long framesEvicted; // Frames evicted from its processes
+    int reclaims; // Times it evicted its own processes to get back within its limit
+    int finished; // Processes of the group that finished
+    double totalTurnaroundTime; // Sum of their turnaround times
+} GroupStats;
+
+// Running totals used for the task 5 statistics
+typedef struct {
+    int simulationTime; // Current simulation time, the makespan once finished
+    int numberOfProcesses; // Number of processes that have finished
+    int memoryWaiting; // Processes waiting for memory, once finished the ones that need more than exists
+    int invalidInput; // 1 if a workload process could not be created, the rest of the input was dropped
+    long unfinished; // Processes left when the simulation stopped because nothing could run again
+    double totalTurnaroundTime; // Sum of turnaround times of finished processes
+    double totTimeOverhead; // Sum of time overheads of finished processes
+    double maxTimeOverhead; // Largest time overhead seen so far
+    int contextSwitches; // Context switches charged by the switch cost model
+    long switchOverhead; // Total time spent switching
+    long swappedIn; // KB read back from the swap device
+    long swappedOut; // KB written to the swap device
+    long swapWaitTime; // Total time processes spent blocked on swap I/O
+    int directReclaims; // Loads that had to evict frames themselves
+    int backgroundReclaims; // Background reclaim passes that evicted something
+    long backgroundFrames; // Frames evicted by background reclaim
+    long tlbHits; // Page references translated by the TLB
+    long tlbMisses; // Page references that needed a page walk
+    long tlbMissCycles; // Cycles spent on page walks
+    long tlbOverhead; // Simulation time added by page walks
+    long pageReferencesMade; // Page references made under demand paging
+    long pageFaults; // Of those, references to pages that were not resident
+    long faultOverhead; // Simulation time added by page faults
+    long peakWorkingSet; // Largest total working set of the active processes, in pages
+    int suspensions; // Processes the load controller swapped out
+    int resumptions; // Suspended processes it let back in
+    long framesEvicted; // Frames evicted by every path
+    int controlStart; // Time of the first suspension, -1 if there was none
+    long framesEvictedBeforeControl; // Frames evicted up to the first suspension
+    int processSwapOuts; // Whole processes swapped out under first-fit
+    int processSwapIns; // Whole processes swapped back in
+    long processSwappedOutKB; // KB of those swap-outs
+    long processSwappedInKB; // KB of those swap-ins
+    long sharedPagesMapped; // Shared pages mapped by the paged and virtual strategies
+    long sharedFramesReused; // Of those, pages that found their frame already resident
+    long cowCopies; // Shared pages copied into a private frame on write
+    int peakPhysicalKB; // Most memory in frames at once
+    int peakVirtualKB; // Most memory mapped at once, counting every mapping of a shared frame
+    GroupStats groups[MAX_MEMORY_GROUPS]; // Memory groups by id
+    int groupCount; // Memory groups that asked for frames
+    long pagesMapped; // Pages given frames by the paged and virtual strategies
+    long hugePagesMapped; // Of those, pages mapped by a huge page
+    long hugeWasteFrames; // Frames of huge pages no page of their process uses
+    int hugeFallbacks; // Allocations that found no free aligned group for a huge page
+    int hugeSplits; // Huge pages split by a partial eviction
+    long numaLocalAccesses; // Page references to memory on the node of the core
+    long numaRemoteAccesses; // Page references to memory on another node
+    long numaOverhead; // Simulation time added by remote references and migrations
+    long pagesMigrated; // Pages moved to the node of the core their process was scheduled on
+    int numaNodes; // Memory nodes
+    int nodePeakKB[MAX_NUMA_NODES]; // Most memory each node held at once
+    int peakHoleCount; // Most first-fit holes at once
+    double worstFragmentation; // Highest external fragmentation index seen by first-fit
+    int admissionFailures; // Loads that found no memory for their process, every retry counts
+    int fragmentedFailures; // Of those, first-fit loads that failed with enough free memory in total
+    Histogram turnaroundHistogram; // Turnaround times of finished processes
+    Histogram waitingHistogram; // Turnaround less service time, the time spent not running
+    Histogram responseHistogram; // Time from arrival to first running
+    Histogram overheadHistogram; // Time overheads in hundredths
+} SchedulerStats;
+
+// Memory state shared by every process regardless of the scheduling policy
+typedef struct {
+    MemoryStrategy strategy; // Memory strategy in use
+    MemoryManager *memoryManager; // Hole list for first-fit, NULL otherwise
+    int memoryUsed; // KB allocated through the hole list
+    FrameTable frameTable; // Frames for the paged and virtual strategies
+    bool demandPaging; // Virtual memory maps pages on first reference instead of on load
+    FILE *output; // Where swap events go, NULL to stay quiet
+    ProcessSwapPolicy swapPolicy; // Medium-term swapping of whole processes under first-fit
+    Process **resident; // Processes holding a first-fit hole, tracked only when swapping
+    int residentCount; // Number of resident processes
+    int residentCapacity; // Slots allocated for resident processes
+    int processSwapOuts; // Whole processes swapped out
+    int processSwapIns; // Whole processes swapped back in
+    long swappedOutKB; // KB of whole processes written to the backing store
+    long swappedInKB; // KB of whole processes read back
+    int numaNodes; // Memory nodes the memory is split into evenly, 1 without NUMA
+    int preferredNode; // Node of the core the next process is loaded for
+    bool interleave; // First-fit places successive blocks on successive nodes
+    int nextNode; // Node the next interleaved first-fit block tries first
+    int nodeUsedKB[MAX_NUMA_NODES]; // First-fit KB allocated on each node
+    int nodePeakKB[MAX_NUMA_NODES]; // Most first-fit KB each node held at once
+    long pagesMigrated; // First-fit pages moved between nodes
+    bool printHealth; // RUNNING events carry hole or frame metrics
+    int admissionFailures; // Loads that found no memory for their process, every retry counts
+    int fragmentedFailures; // Of those, first-fit loads that failed with enough free memory in total
+    double worstFragmentation; // Highest external fragmentation index after a first-fit load or release
+} MemoryState;
+
+void initializeSchedulerOptions(SchedulerOptions *options);
+void runScheduling(Queue *allProcesses, int quantum, MemoryStrategy strategy, SchedulerOptions *options, SchedulerStats *stats);
+void runPolicyScheduling(Queue *allProcesses, int quantum, MemoryStrategy strategy, SchedulerOptions *options, SchedulerStats *stats);
+
+void initializeMemoryState(MemoryState *memory, MemoryStrategy strategy, FILE *output);
+void freeMemoryState(MemoryState *memory);
+int loadProcess(MemoryState *memory, Process *process, int simulationTime);
+void releaseProcess(MemoryState *memory, Process *process, int simulationTime);
+int migrateProcess(MemoryState *memory, Process *process, int node);
+int memoryOnNode(MemoryState *memory, Process *process, int node);
+void printRunningEvent(FILE *output, MemoryState *memory, Process *process, int simulationTime, int cpu);
+void printFinishedEvent(FILE *output, Process *process, int simulationTime, int procRemaining, int cpu);
+void recordFinishedProcess(SchedulerStats *stats, Process *process);
+void recordLatencies(SchedulerStats *stats, Process *process);
+void printLatencyStatistics(FILE *output, SchedulerStats *stats);
+int averageTurnaroundTime(SchedulerStats *stats);
+double averageTimeOverhead(SchedulerStats *stats);
+void printStatistics(FILE *output, SchedulerStats *stats);
+int hasSwitchCost(SchedulerOptions *options);
+int contextSwitchCost(SchedulerOptions *options, Process *process, int cpu, int simulationTime);
+void printSwitchStatistics(FILE *output, SchedulerStats *stats);
+int hasSwapDevice(SchedulerOptions *options);
+void printSwapStatistics(FILE *output, SchedulerStats *stats);
+int hasBackgroundReclaim(SchedulerOptions *options);
+void printReclaimStatistics(FILE *output, SchedulerStats *stats);
+int hasTlb(SchedulerOptions *options);
+void printTlbStatistics(FILE *output, SchedulerStats *stats);
+int hasHugePages(SchedulerOptions *options);
+void printHugePageStatistics(FILE *output, SchedulerStats *stats);
+void printPageFaultStatistics(FILE *output, SchedulerStats *stats);
+void printWorkingSetStatistics(FILE *output, SchedulerStats *stats, bool loadControl);
+void printProcessSwapStatistics(FILE *output, SchedulerStats *stats);
+int hasPagedExtensions(Queue *processes, const Workload *workload);
+void printSharedMemoryStatistics(FILE *output, SchedulerStats *stats);
+void printGroupStatistics(FILE *output, SchedulerStats *stats);
+int hasNuma(SchedulerOptions *options);
+void printNumaStatistics(FILE *output, SchedulerStats *stats);
+void printMemoryHealthStatistics(FILE *output, SchedulerStats *stats, MemoryStrategy strategy);
+
+#endif
@@ -0,0 +1,1383 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Simulation.h"
+#include "Checkpoint.h"
+#include "FairQueue.h"
+#include "FeedbackQueue.h"
+#include "Profile.h"
+#include "SwapDevice.h"
+#include "Trace.h"
+
+// Run queue of whichever policy is selected
+typedef struct {
+    SchedulingPolicy policy; // Policy deciding the order of the queue
+    int quantum; // Base quantum, the minimum granularity for the fair policy
+    Queue *fifo; // Plain FIFO for round robin
+    FairQueue *fair; // Virtual runtime tree for the fair policy
+    FeedbackQueue *feedback; // Priority levels for the feedback policy
+    int boostInterval; // Time between feedback priority boosts
+    int nextBoost; // Simulation time of the next feedback priority boost
+} RunQueue;
+
+// A simulated CPU with its own run queue
+typedef struct {
+    RunQueue runQueue; // Processes waiting for this core
+    Process *currentProcess; // Process running on this core, NULL when idle
+    Process *previousProcess; // Last process that ran here, so continuing it prints no new RUNNING event
+    int sliceStart; // Simulation time at which the current slice started
+    int sliceEnd; // Simulation time at which the current slice ends
+    int runTime; // Time the current slice spends running the process, less than the slice when it finishes early
+    Tlb tlb; // Translations of this core, used when the TLB model is enabled
+    long tlbCycles; // Page walk cycles not yet charged as a whole unit of time
+    long faultCycles; // Page fault cycles not yet charged as a whole unit of time
+    int node; // Memory node the core sits on
+    long numaCycles; // Remote access and migration cycles not yet charged as a whole unit of time
+} Core;
+
+static int initializeRunQueue(RunQueue *runQueue, int quantum, SchedulerOptions *options) {
+    runQueue->policy = options->policy;
+    runQueue->quantum = quantum;
+    runQueue->fifo = NULL;
+    runQueue->fair = NULL;
+    runQueue->feedback = NULL;
+    runQueue->boostInterval = options->boostInterval > 0 ? options->boostInterval : FEEDBACK_DEFAULT_BOOST_QUANTA * quantum;
+    runQueue->nextBoost = runQueue->boostInterval;
+
+    if (options->policy == FAIR) {
+        runQueue->fair = createFairQueue();
+        return runQueue->fair ? 0 : -1;
+    } else if (options->policy == FEEDBACK) {
+        runQueue->feedback = createFeedbackQueue(options->feedbackLevels, quantum);
+        return runQueue->feedback ? 0 : -1;
+    }
+    runQueue->fifo = createQueue();
+    return runQueue->fifo ? 0 : -1;
+}
+
+static int runQueueCount(RunQueue *runQueue) {
+    if (runQueue->policy == FAIR) {
+        return runQueue->fair->count;
+    } else if (runQueue->policy == FEEDBACK) {
+        return runQueue->feedback->count;
+    }
+    return runQueue->fifo->count;
+}
+
+// Add a process that was not running: a new arrival, a stolen process or one that waited for memory
+static void addToRunQueue(RunQueue *runQueue, Process *process) {
+    if (runQueue->policy == FAIR) {
+        placeProcess(runQueue->fair, process);
+        fairEnqueue(runQueue->fair, process);
+    } else if (runQueue->policy == FEEDBACK) {
+        feedbackEnqueue(runQueue->feedback, process, process->priority);
+    } else {
+        enqueue(runQueue->fifo, process);
+    }
+}
+
+static Process* pickFromRunQueue(RunQueue *runQueue) {
+    if (runQueue->policy == FAIR) {
+        return fairDequeueMin(runQueue->fair);
+    } else if (runQueue->policy == FEEDBACK) {
+        return feedbackDequeue(runQueue->feedback, NULL);
+    }
+    return dequeue(runQueue->fifo);
+}
+
+static int runQueueTimeslice(RunQueue *runQueue, Process *process) {
+    if (runQueue->policy == FAIR) {
+        return fairTimeslice(runQueue->fair, runQueue->quantum);
+    } else if (runQueue->policy == FEEDBACK) {
+        return runQueue->feedback->quantums[process->priority];
+    }
+    return runQueue->quantum;
+}
+
+// Put back a process whose timeslice ran out
+static void requeueProcess(RunQueue *runQueue, Process *process) {
+    if (runQueue->policy == FAIR) {
+        fairEnqueue(runQueue->fair, process);
+    } else if (runQueue->policy == FEEDBACK) {
+        // It used its whole quantum, so it drops a level
+        feedbackEnqueue(runQueue->feedback, process, process->priority + 1);
+    } else {
+        enqueue(runQueue->fifo, process);
+    }
+}
+
+// Periodic work that depends only on the passage of time
+static void runQueueTick(RunQueue *runQueue, int simulationTime) {
+    if (runQueue->policy == FEEDBACK && simulationTime >= runQueue->nextBoost) {
+        feedbackBoost(runQueue->feedback);
+        while (runQueue->nextBoost <= simulationTime) {
+            runQueue->nextBoost += runQueue->boostInterval;
+        }
+    }
+}
+
+static void freeRunQueue(RunQueue *runQueue) {
+    if (runQueue->fifo) {
+        freeQueue(runQueue->fifo);
+    }
+    if (runQueue->fair) {
+        freeFairQueue(runQueue->fair);
+    }
+    if (runQueue->feedback) {
+        freeFeedbackQueue(runQueue->feedback);
+    }
+}
+
+struct Simulation {
+    int quantum; // Base quantum
+    SchedulerOptions options; // Policy, number of cores and output
+    Queue *allProcesses; // Processes that have not arrived yet, in arrival order
+    Core *cores; // Simulated CPUs
+    int numCores; // Number of simulated CPUs
+    Queue *memoryWaitQueue; // Processes that could not be given memory until some is freed
+    Queue *blockedQueue; // Processes waiting for their swap I/O to complete
+    Queue *suspendedQueue; // Processes the load controller swapped out, oldest first
+    long activeWorkingSet; // Working set pages of every admitted process that is not suspended
+    SwapDevice swapDevice; // Backing store timing, used when the options enable it
+    int tlbEnabled; // The TLB model applies, only to the paged and virtual strategies
+    int numaEnabled; // The NUMA model applies, to every strategy but infinite memory
+    MemoryState memory; // Memory shared by every core
+    SchedulerStats stats; // Running statistics, simulationTime is the current time
+    int processCount; // Processes added so far
+    Trace *trace; // Chrome trace being written, NULL when there is none
+    long tracedFrames; // Frames evicted up to the last eviction in the trace
+    long tracedSwappedOutKB; // KB of whole processes swapped out up to then
+    int tracedUsage; // Memory usage in the last counter event of the trace, -1 before the first
+    int tracedFree; // Free frames or holes in that event
+    long events; // Scheduling events processed so far, what a checkpoint by events counts
+    long workloadNext; // Next process of options.workload to create
+    int arrivalPreemption; // Arrivals take the core from a lone process, as in the reference loop
+};
+
+// Number of processes a core is responsible for, including the one it is running
+static int coreLoad(Core *core) {
+    return runQueueCount(&core->runQueue) + (core->currentProcess ? 1 : 0);
+}
+
+static Core* leastLoadedCore(Simulation *simulation) {
+    Core *target = &simulation->cores[0];
+    for (int i = 1; i < simulation->numCores; i++) {
+        if (coreLoad(&simulation->cores[i]) < coreLoad(target)) {
+            target = &simulation->cores[i];
+        }
+    }
+    return target;
+}
+
+// Every state change goes through here, so the trace sees how long a process waited
+static void changeState(Simulation *simulation, Process *process, ProcessState state) {
+    int now = simulation->stats.simulationTime;
+    if (simulation->trace && process->state != NEW && process->state != RUNNING && process->stateSince < now) {
+        traceStateSlice(simulation->trace, process, process->state, process->stateSince, now);
+    }
+    // Time moves in jumps, a new arrival has waited since it arrived
+    process->stateSince = process->state == NEW ? process->arrivalTime : now;
+    process->state = state;
+}
+
+// Hand a process that was not running to the least loaded core
+static void makeReady(Simulation *simulation, Process *process) {
+    changeState(simulation, process, READY);
+    addToRunQueue(&leastLoadedCore(simulation)->runQueue, process);
+}
+
+// Processes waiting in any run queue, not counting the ones running
+static int readyCount(Simulation *simulation) {
+    int count = 0;
+    for (int i = 0; i < simulation->numCores; i++) {
+        count += runQueueCount(&simulation->cores[i].runQueue);
+    }
+    return count;
+}
+
+// Create the next process of a mapped workload once every queued one has arrived, so
+// only the processes the simulation has reached are ever built
+static void refillArrivals(Simulation *simulation) {
+    const Workload *workload = simulation->options.workload;
+    if (!workload || !isQueueEmpty(simulation->allProcesses) || simulation->workloadNext >= workload->count) {
+        return;
+    }
+    Process *process = createWorkloadProcess(workload, simulation->workloadNext);
+    if (!process) {
+        // The rest of the input is dropped, like a text input that fails to load
+        fprintf(stderr, "Invalid process %ld in the workload\n", simulation->workloadNext);
+        simulation->workloadNext = workload->count;
+        simulation->stats.invalidInput = 1;
+        return;
+    }
+    simulation->workloadNext++;
+    process->id = simulation->processCount++;
+    enqueue(simulation->allProcesses, process);
+}
+
+// Move every process that has arrived by now to the least loaded core
+static void admitArrivals(Simulation *simulation) {
+    Queue *allProcesses = simulation->allProcesses;
+    PROFILE_BEGIN(PHASE_ARRIVAL);
+    refillArrivals(simulation);
+    while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulation->stats.simulationTime) {
+        Process *newProcess = dequeue(allProcesses);
+        if (simulation->trace) {
+            traceProcessTrack(simulation->trace, newProcess);
+        }
+        makeReady(simulation, newProcess);
+        refillArrivals(simulation);
+    }
+    PROFILE_END();
+}
+
+// Move every process whose swap I/O has completed by now to the least loaded core
+static void wakeBlockedProcesses(Simulation *simulation) {
+    Queue *blockedQueue = simulation->blockedQueue;
+    for (int count = blockedQueue->count; count > 0; count--) {
+        Process *process = dequeue(blockedQueue);
+        if (process->blockedUntil <= simulation->stats.simulationTime) {
+            makeReady(simulation, process);
+        } else {
+            enqueue(blockedQueue, process);
+        }
+    }
+}
+
+// Freed memory may let waiting processes in again
+static void wakeMemoryWaiters(Simulation *simulation) {
+    while (!isQueueEmpty(simulation->memoryWaitQueue)) {
+        makeReady(simulation, dequeue(simulation->memoryWaitQueue));
+    }
+}
+
+// Time the earliest blocked process becomes ready, INT_MAX if none is blocked
+static int nextWakeTime(Simulation *simulation) {
+    int wakeTime = INT_MAX;
+    for (Node *node = simulation->blockedQueue->front; node; node = node->next) {
+        if (node->data->blockedUntil < wakeTime) {
+            wakeTime = node->data->blockedUntil;
+        }
+    }
+    return wakeTime;
+}
+
+// KB written to the backing store so far, by evicted frames and swapped out processes
+static long swappedOutKB(Simulation *simulation) {
+    return simulation->memory.frameTable.framesSwappedOut * PAGE_SIZE + simulation->memory.swappedOutKB;
+}
+
+// Submit the swap traffic caused by loading process: the frames it took from other
+// processes are written out and, if it was swapped out itself, its pages are read back.
+// Return 1 if the process was loaded and has to block until that I/O completes
+static int startSwapIO(Simulation *simulation, Process *process, int loaded, int wasResident, long swappedOutBefore,
+                       long swappedInBefore) {
+    SchedulerStats *stats = &simulation->stats;
+    MemoryState *memory = &simulation->memory;
+    // A failed load may still have evicted frames or swapped out processes before giving up
+    int swapOut = (int)(swappedOutKB(simulation) - swappedOutBefore);
+
+    // First-fit reads whole processes back, the paged strategies only their evicted pages
+    int swapIn = (int)(memory->swappedInKB - swappedInBefore);
+    if (loaded && !wasResident && process->swappedPages > 0 && memory->strategy != FIRST_FIT && !memory->demandPaging) {
+        int pages = process->swappedPages < process->numFramesAllocated ? process->swappedPages : process->numFramesAllocated;
+        process->swappedPages -= pages;
+        swapIn += pages * PAGE_SIZE;
+    }
+    if (swapOut == 0 && swapIn == 0) {
+        return 0;
+    }
+
+    // Both transfers are issued together, the process runs once the later one is done
+    int readyTime = stats->simulationTime;
+    if (swapOut > 0) {
+        readyTime = submitSwapRequest(&simulation->swapDevice, swapOut, stats->simulationTime);
+    }
+    if (swapIn > 0) {
+        int swapInDone = submitSwapRequest(&simulation->swapDevice, swapIn, stats->simulationTime);
+        readyTime = swapInDone > readyTime ? swapInDone : readyTime;
+    }
+    stats->swappedOut += swapOut;
+    stats->swappedIn += swapIn;
+    if (loaded) {
+        stats->swapWaitTime += readyTime - stats->simulationTime;
+    }
+
+    printEvent(simulation->options.output, "%d,SWAPPING,process-name=%s,swap-in=%dKB,swap-out=%dKB,ready-at=%d\n",
+               stats->simulationTime, process->name, swapIn, swapOut, readyTime);
+    if (!loaded) {
+        return 0;
+    }
+    changeState(simulation, process, BLOCKED);
+    process->blockedUntil = readyTime;
+    enqueue(simulation->blockedQueue, process);
+    return 1;
+}
+
+// Charge frames evicted outside a load to the swap device. The write-back occupies the
+// device but no process waits for it
+static void writeBackFrames(Simulation *simulation, int frames) {
+    if (hasSwapDevice(&simulation->options) && frames > 0) {
+        submitSwapRequest(&simulation->swapDevice, frames * PAGE_SIZE, simulation->stats.simulationTime);
+        simulation->stats.swappedOut += frames * PAGE_SIZE;
+    }
+}
+
+// Between quanta, evict by LRU order up to the high watermark once free frames drop
+// below the low one, so later loads find free frames instead of reclaiming themselves
+static void backgroundReclaim(Simulation *simulation) {
+    MemoryState *memory = &simulation->memory;
+    SchedulerOptions *options = &simulation->options;
+    if (!hasBackgroundReclaim(options) || (memory->strategy != PAGED && memory->strategy != VIRTUAL) ||
+        findFreeFrames(&memory->frameTable) >= options->reclaimLowWatermark) {
+        return;
+    }
+
+    SchedulerStats *stats = &simulation->stats;
+    int evicted = reclaimFrames(&memory->frameTable, options->reclaimHighWatermark, memory->strategy == VIRTUAL, stats->simulationTime);
+    if (evicted == 0) {
+        return;
+    }
+    stats->backgroundReclaims++;
+    stats->backgroundFrames += evicted;
+    writeBackFrames(simulation, evicted);
+    wakeMemoryWaiters(simulation);
+}
+
+// Turn stall cycles into whole units of time, carrying the remainder in carry
+static int cyclesToTime(long *carry, long cycles) {
+    *carry += cycles;
+    int time = (int)(*carry / CYCLES_PER_TIME_UNIT);
+    *carry %= CYCLES_PER_TIME_UNIT;
+    return time;
+}
+
+// Count references by whether they reach memory on the node of core, and charge the
+// remote ones. Return the time they add to the slice
+static int chargeNumaAccesses(Simulation *simulation, Core *core, long local, long remote) {
+    SchedulerStats *stats = &simulation->stats;
+    stats->numaLocalAccesses += local;
+    stats->numaRemoteAccesses += remote;
+    int numaTime = cyclesToTime(&core->numaCycles, remote * simulation->options.numaRemotePenalty);
+    stats->numaOverhead += numaTime;
+    return numaTime;
+}
+
+// Generate the page references a slice of runTime makes on core. Under demand paging
+// a reference to a page that is not resident faults it in, otherwise the process
+// touches only its resident pages. With the TLB model every reference is translated and
+// writes to shared pages copy them when copy-on-write is on. Under NUMA a reference to a
+// frame on another node than the core's is remote.
+// Return the time the page faults, copies, TLB misses and remote references add to the slice
+static int runPageReferences(Simulation *simulation, Core *core, Process *process, int runTime) {
+    SchedulerStats *stats = &simulation->stats;
+    SchedulerOptions *options = &simulation->options;
+    FrameTable *table = &simulation->memory.frameTable;
+    int demandPaging = simulation->memory.demandPaging;
+    int pages = demandPaging ? (process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE : process->numFramesAllocated;
+    if (pages <= 0) {
+        return 0;
+    }
+
+    if (simulation->tlbEnabled) {
+        tlbSwitch(&core->tlb, process);
+    }
+    int workingSetBefore = 0;
+    if (simulation->options.workingSetWindow > 0 && !process->workingSet) {
+        process->workingSet = createWorkingSet((process->memoryRequirement + PAGE_SIZE - 1) / PAGE_SIZE, simulation->options.workingSetWindow);
+    }
+    if (process->workingSet) {
+        workingSetBefore = process->workingSet->size;
+    }
+    long hitsBefore = core->tlb.hits;
+    long missesBefore = core->tlb.misses;
+    long faults = 0;
+    long copies = 0;
+    long local = 0;
+    long remote = 0;
+    int evictedFrames[TOTAL_FRAMES] = {0};
+    long references = (long)runTime * options->pageReferences;
+    for (long r = 0; r < references; r++) {
+        int page = nextPageReference(process->referenceModel, process->pageReferences++, pages);
+        if (demandPaging && touchPage(table, process, page, evictedFrames) != 0) {
+            faults++;
+        }
+        if (options->cowWritePercent > 0 && isWriteReference(process->pageReferences - 1, options->cowWritePercent) &&
+            copyOnWrite(table, process, page, simulation->memory.strategy == VIRTUAL, evictedFrames) == 1) {
+            copies++;
+        }
+        if (simulation->tlbEnabled) {
+            tlbLookup(&core->tlb, page);
+        }
+        if (simulation->numaEnabled && process->frameAllocations && process->frameAllocations[page] >= 0) {
+            if (frameNode(table, process->frameAllocations[page]) == core->node) {
+                local++;
+            } else {
+                remote++;
+            }
+        }
+        if (process->workingSet) {
+            recordReference(process->workingSet, page);
+        }
+    }
+
+    if (process->workingSet) {
+        simulation->activeWorkingSet += process->workingSet->size - workingSetBefore;
+        if (simulation->activeWorkingSet > stats->peakWorkingSet) {
+            stats->peakWorkingSet = simulation->activeWorkingSet;
+        }
+    }
+
+    int overhead = 0;
+    printEvictedFrames(table, evictedFrames, stats->simulationTime);
+    if (demandPaging) {
+        process->pageFaults += faults;
+        stats->pageReferencesMade += references;
+        stats->pageFaults += faults;
+        int faultTime = cyclesToTime(&core->faultCycles, faults * options->faultPenalty);
+        stats->faultOverhead += faultTime;
+        overhead += faultTime;
+    }
+    if (copies > 0) {
+        // A copy is a write fault served from memory
+        int copyTime = cyclesToTime(&core->faultCycles, copies * options->faultPenalty);
+        stats->faultOverhead += copyTime;
+        overhead += copyTime;
+    }
+    if (simulation->tlbEnabled) {
+        long misses = core->tlb.misses - missesBefore;
+        long cycles = misses * options->tlbMissPenalty;
+        stats->tlbHits += core->tlb.hits - hitsBefore;
+        stats->tlbMisses += misses;
+        stats->tlbMissCycles += cycles;
+        int tlbTime = cyclesToTime(&core->tlbCycles, cycles);
+        stats->tlbOverhead += tlbTime;
+        overhead += tlbTime;
+    }
+    if (simulation->numaEnabled) {
+        overhead += chargeNumaAccesses(simulation, core, local, remote);
+    }
+    return overhead;
+}
+
+// Drop the translations of process from every core, its pages moved or it finished
+static void invalidateTranslations(Simulation *simulation, Process *process) {
+    if (!simulation->tlbEnabled) {
+        return;
+    }
+    for (int i = 0; i < simulation->numCores; i++) {
+        tlbInvalidate(&simulation->cores[i].tlb, process);
+    }
+}
+
+static int workingSetSize(Process *process) {
+    return process->workingSet ? process->workingSet->size : 0;
+}
+
+// Processes competing for memory: queued, running or blocked. The ones waiting for
+// memory are left out, they hold none and only run once some is freed
+static int activeCount(Simulation *simulation) {
+    int count = readyCount(simulation) + simulation->blockedQueue->count;
+    for (int i = 0; i < simulation->numCores; i++) {
+        if (simulation->cores[i].currentProcess) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Load control: swap out a process whose slice just ended, rather than requeue it,
+// while the active working sets exceed memory. Return 1 if it was suspended
+static int suspendIfOverloaded(Simulation *simulation, Process *process) {
+    SchedulerStats *stats = &simulation->stats;
+    MemoryState *memory = &simulation->memory;
+    if (!simulation->options.loadControl || (memory->strategy != PAGED && memory->strategy != VIRTUAL) ||
+        simulation->activeWorkingSet <= TOTAL_FRAMES || activeCount(simulation) == 0) {
+        return 0;
+    }
+
+    if (stats->controlStart < 0) {
+        stats->controlStart = stats->simulationTime;
+        stats->framesEvictedBeforeControl = memory->frameTable.framesSwappedOut;
+    }
+    simulation->activeWorkingSet -= workingSetSize(process);
+    printEvent(simulation->options.output, "%d,SUSPENDED,process-name=%s,working-set=%d,total-working-set=%ld\n",
+               stats->simulationTime, process->name, workingSetSize(process), simulation->activeWorkingSet);
+    writeBackFrames(simulation, swapOutProcess(&memory->frameTable, process, stats->simulationTime));
+    invalidateTranslations(simulation, process);
+    changeState(simulation, process, SUSPENDED);
+    enqueue(simulation->suspendedQueue, process);
+    wakeMemoryWaiters(simulation);
+    stats->suspensions++;
+    return 1;
+}
+
+// Let suspended processes back in, oldest first, while their working sets fit. One is
+// always let in when nothing else is left to run
+static void resumeSuspended(Simulation *simulation) {
+    Queue *suspendedQueue = simulation->suspendedQueue;
+    while (!isQueueEmpty(suspendedQueue)) {
+        Process *process = peek(suspendedQueue);
+        if (simulation->activeWorkingSet + workingSetSize(process) > TOTAL_FRAMES && activeCount(simulation) > 0) {
+            break;
+        }
+        dequeue(suspendedQueue);
+        simulation->activeWorkingSet += workingSetSize(process);
+        printEvent(simulation->options.output, "%d,RESUMED,process-name=%s,working-set=%d,total-working-set=%ld\n",
+                   simulation->stats.simulationTime, process->name, workingSetSize(process), simulation->activeWorkingSet);
+        makeReady(simulation, process);
+        simulation->stats.resumptions++;
+    }
+}
+
+// An idle core with nothing queued takes the next process of the busiest run queue
+static Process* stealProcess(Simulation *simulation, Core *thief) {
+    Core *victim = NULL;
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        if (core != thief && runQueueCount(&core->runQueue) > 0 &&
+            (!victim || runQueueCount(&core->runQueue) > runQueueCount(&victim->runQueue))) {
+            victim = core;
+        }
+    }
+    return victim ? pickFromRunQueue(&victim->runQueue) : NULL;
+}
+
+Simulation* createSimulation(int quantum, MemoryStrategy strategy, SchedulerOptions *options) {
+    if (quantum < 1 || options->cores < 1) {
+        return NULL;
+    }
+
+    Simulation *simulation = (Simulation *)calloc(1, sizeof(Simulation));
+    if (!simulation) {
+        return NULL;
+    }
+    simulation->quantum = quantum;
+    simulation->options = *options;
+    if (simulation->options.warmthDecay <= 0) {
+        simulation->options.warmthDecay = quantum;
+    }
+    if (simulation->options.reclaimHighWatermark < simulation->options.reclaimLowWatermark) {
+        simulation->options.reclaimHighWatermark = simulation->options.reclaimLowWatermark;
+    }
+    simulation->numCores = options->cores;
+    // The reference loop's round robin under infinite and first-fit memory
+    simulation->arrivalPreemption = options->policy == ROUND_ROBIN && options->cores == 1 &&
+                                    (strategy == INFINITE || strategy == FIRST_FIT);
+    simulation->allProcesses = createQueue();
+    simulation->memoryWaitQueue = createQueue();
+    simulation->blockedQueue = createQueue();
+    simulation->suspendedQueue = createQueue();
+    simulation->stats.controlStart = -1;
+    simulation->cores = (Core *)calloc(options->cores, sizeof(Core));
+    if (!simulation->allProcesses || !simulation->memoryWaitQueue || !simulation->blockedQueue || !simulation->suspendedQueue || !simulation->cores) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    for (int i = 0; i < simulation->numCores; i++) {
+        if (initializeRunQueue(&simulation->cores[i].runQueue, quantum, options) != 0) {
+            destroySimulation(simulation);
+            return NULL;
+        }
+    }
+    if (hasSwapDevice(options) &&
+        initializeSwapDevice(&simulation->swapDevice, options->swapLatency, options->swapBandwidth, options->swapQueueDepth) != 0) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    simulation->tlbEnabled = hasTlb(options) && (strategy == PAGED || strategy == VIRTUAL);
+    for (int i = 0; simulation->tlbEnabled && i < simulation->numCores; i++) {
+        if (initializeTlb(&simulation->cores[i].tlb, options->tlbEntries, options->tlbWays, options->tlbReplacement, options->tlbTagged) != 0) {
+            destroySimulation(simulation);
+            return NULL;
+        }
+    }
+    if (hasHugePages(options) &&
+        (options->hugePageFrames & (options->hugePageFrames - 1) || TOTAL_FRAMES % options->hugePageFrames != 0)) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    if (hasNuma(options) && options->numaNodes > MAX_NUMA_NODES) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    initializeMemoryState(&simulation->memory, strategy, options->output);
+    if (strategy == PAGED || strategy == VIRTUAL) {
+        simulation->memory.frameTable.hugeFrames = hasHugePages(options) ? options->hugePageFrames : 0;
+    }
+    // Each node gets an even share of the cores, in order
+    simulation->numaEnabled = hasNuma(options) && strategy != INFINITE;
+    if (simulation->numaEnabled) {
+        simulation->memory.numaNodes = options->numaNodes;
+        simulation->memory.interleave = options->numaPolicy == NUMA_INTERLEAVE;
+        simulation->memory.frameTable.numaNodes = options->numaNodes;
+        simulation->memory.frameTable.interleave = options->numaPolicy == NUMA_INTERLEAVE;
+        for (int i = 0; i < simulation->numCores; i++) {
+            simulation->cores[i].node = i * options->numaNodes / simulation->numCores;
+        }
+    }
+    simulation->memory.demandPaging = options->demandPaging && strategy == VIRTUAL;
+    simulation->memory.swapPolicy = strategy == FIRST_FIT ? options->processSwapPolicy : SWAP_NONE;
+    simulation->memory.printHealth = options->memoryHealth;
+    if (strategy == FIRST_FIT && !simulation->memory.memoryManager) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    simulation->tracedUsage = -1;
+    if (options->tracePath && !(simulation->trace = openTrace(options->tracePath, simulation->numCores))) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    return simulation;
+}
+
+// Queue a process that the caller already built, taking ownership of it. It may not
+// arrive before the last process queued, nor before the current time
+static int addProcessStruct(Simulation *simulation, Process *process) {
+    Queue *allProcesses = simulation->allProcesses;
+    if (process->arrivalTime < simulation->stats.simulationTime ||
+        (!isQueueEmpty(allProcesses) && allProcesses->rear->data->arrivalTime > process->arrivalTime)) {
+        return -1;
+    }
+    int count = allProcesses->count;
+    process->id = simulation->processCount;
+    enqueue(allProcesses, process);
+    if (allProcesses->count == count) {
+        return -1;
+    }
+    simulation->processCount++;
+    return 0;
+}
+
+int addProcess(Simulation *simulation, const char *name, int arrivalTime, int serviceTime, int memoryRequirement) {
+    return addProcessWithColumns(simulation, name, arrivalTime, serviceTime, memoryRequirement, NULL);
+}
+
+int addProcessWithColumns(Simulation *simulation, const char *name, int arrivalTime, int serviceTime, int memoryRequirement,
+                          const char *columns) {
+    if (serviceTime < 1 || memoryRequirement < 0) {
+        return -1;
+    }
+    Process *process = (Process *)calloc(1, sizeof(Process));
+    if (!process) {
+        return -1;
+    }
+    strncpy(process->name, name, sizeof(process->name) - 1);
+    process->arrivalTime = arrivalTime;
+    process->serviceTime = serviceTime;
+    process->memoryRequirement = memoryRequirement;
+    initializeInputProcess(process);
+    // Parsed from a copy, the parser cuts the columns apart in place
+    char *copy = columns ? strdup(columns) : NULL;
+    int failed = (columns && (!copy || parseProcessColumns(process, copy) != 0)) || addProcessStruct(simulation, process) != 0;
+    free(copy);
+    if (failed) {
+        freeProcess(process);
+        return -1;
+    }
+    return 0;
+}
+
+// Trace the frames evicted and processes swapped out since the last eviction traced, on
+// the track of cpu when loading process caused them, globally when cpu is -1
+static void traceEvictions(Simulation *simulation, int cpu, Process *process) {
+    long frames = simulation->memory.frameTable.framesSwappedOut;
+    long swappedOutKB = simulation->memory.swappedOutKB;
+    if (frames == simulation->tracedFrames && swappedOutKB == simulation->tracedSwappedOutKB) {
+        return;
+    }
+    traceEviction(simulation->trace, simulation->stats.simulationTime, cpu, process, frames - simulation->tracedFrames,
+                  swappedOutKB - simulation->tracedSwappedOutKB);
+    simulation->tracedFrames = frames;
+    simulation->tracedSwappedOutKB = swappedOutKB;
+}
+
+// Trace evictions outside a load and the memory counters, whenever they changed
+static void traceMemoryChanges(Simulation *simulation) {
+    if (!simulation->trace) {
+        return;
+    }
+    traceEvictions(simulation, -1, NULL);
+
+    MemoryState *memory = &simulation->memory;
+    int usage;
+    int freeCount;
+    const char *freeName;
+    if (memory->strategy == FIRST_FIT) {
+        usage = (memory->memoryUsed * 100 + TOTAL_MEMORY - 1) / TOTAL_MEMORY;
+        freeName = "holes";
+        freeCount = memory->memoryManager->holeCount;
+    } else if (memory->strategy == PAGED || memory->strategy == VIRTUAL) {
+        usage = calculateMemoryUsage(&memory->frameTable);
+        freeName = "free-frames";
+        freeCount = TOTAL_FRAMES - memory->frameTable.framesUsed;
+    } else {
+        return;
+    }
+    if (usage != simulation->tracedUsage || freeCount != simulation->tracedFree) {
+        traceMemory(simulation->trace, simulation->stats.simulationTime, usage, freeName, freeCount);
+        simulation->tracedUsage = usage;
+        simulation->tracedFree = freeCount;
+    }
+}
+
+// Load next for core cpu and submit the swap traffic that causes. Return 1 if it was
+// loaded, with *blocked set when it has to wait for that swap I/O before it runs
+static int loadOnCore(Simulation *simulation, int cpu, Process *next, int *blocked) {
+    int wasResident = next->isAllocated;
+    long framesSwappedBefore = simulation->memory.frameTable.framesSwappedOut;
+    long swappedOutBefore = swappedOutKB(simulation);
+    long swappedInBefore = simulation->memory.swappedInKB;
+    simulation->memory.preferredNode = simulation->cores[cpu].node;
+    PROFILE_BEGIN(PHASE_ALLOCATION);
+    int loaded = loadProcess(&simulation->memory, next, simulation->stats.simulationTime) == 0;
+    PROFILE_END();
+    if (simulation->memory.frameTable.framesSwappedOut > framesSwappedBefore) {
+        simulation->stats.directReclaims++;
+    }
+    if (simulation->trace) {
+        traceEvictions(simulation, cpu, next);
+    }
+    *blocked = hasSwapDevice(&simulation->options) && startSwapIO(simulation, next, loaded, wasResident,
+                                                                  swappedOutBefore, swappedInBefore);
+    if (loaded && !wasResident) {
+        invalidateTranslations(simulation, next);
+    }
+    return loaded;
+}
+
+// Start a slice of next, already loaded, on core cpu. Its RUNNING event is printed
+// unless it is quiet: the process running on, or one the caller printed already
+static void startSlice(Simulation *simulation, int cpu, Process *next, int wasResident, Process *quiet) {
+    Core *core = &simulation->cores[cpu];
+    int simulationTime = simulation->stats.simulationTime;
+    // Only tag events with a cpu when there is more than one to tell apart
+    int cpuField = simulation->numCores > 1;
+
+    // Under migrate-on-schedule memory left on another node follows the process here
+    int migrateTime = 0;
+    if (simulation->numaEnabled && simulation->options.numaPolicy == NUMA_MIGRATE && wasResident) {
+        int migrated = migrateProcess(&simulation->memory, next, core->node);
+        if (migrated > 0) {
+            printEvent(simulation->options.output, "%d,MIGRATED,process-name=%s,node=%d,pages=%d\n",
+                       simulationTime, next->name, core->node, migrated);
+            invalidateTranslations(simulation, next);
+            migrateTime = cyclesToTime(&core->numaCycles, (long)migrated * simulation->options.numaMigrateCost);
+            simulation->stats.numaOverhead += migrateTime;
+        }
+    }
+
+    // Switching to another process first pays for the switch itself and a cold cache
+    int switchOverhead = 0;
+    if (next != core->previousProcess && hasSwitchCost(&simulation->options)) {
+        switchOverhead = contextSwitchCost(&simulation->options, next, cpu, simulationTime);
+        simulation->stats.contextSwitches++;
+        simulation->stats.switchOverhead += switchOverhead;
+    }
+
+    int timeslice = runQueueTimeslice(&core->runQueue, next);
+    core->runTime = timeslice < next->remainingTime ? timeslice : next->remainingTime;
+    int stallTime = migrateTime;
+    if (simulation->tlbEnabled || simulation->memory.demandPaging || simulation->options.workingSetWindow > 0 ||
+        simulation->options.cowWritePercent > 0 ||
+        (simulation->numaEnabled && simulation->memory.strategy != FIRST_FIT)) {
+        stallTime += runPageReferences(simulation, core, next, core->runTime);
+    }
+    if (simulation->numaEnabled && simulation->memory.strategy == FIRST_FIT && next->memoryRequirement > 0) {
+        // A contiguous block has no page table, its references spread evenly over it
+        long references = (long)core->runTime * simulation->options.pageReferences;
+        long local = references * memoryOnNode(&simulation->memory, next, core->node) / next->memoryRequirement;
+        stallTime += chargeNumaAccesses(simulation, core, local, references - local);
+    }
+    // Round robin holds the core for the whole quantum even when the process finishes
+    // early, as the reference loop does, so both loops give the same schedule
+    int heldTime = simulation->options.policy == ROUND_ROBIN ? timeslice : core->runTime;
+    core->sliceStart = simulationTime;
+    core->sliceEnd = simulationTime + switchOverhead + stallTime + heldTime;
+    core->currentProcess = next;
+
+    if (next != quiet) {
+        printRunningEvent(simulation->options.output, &simulation->memory, next, simulationTime, cpuField ? cpu : -1);
+    }
+    changeState(simulation, next, RUNNING);
+    if (next->firstRunTime < 0) {
+        next->firstRunTime = simulationTime;
+    }
+    next->lastUsed = simulationTime;
+    next->lastCpu = cpu;
+}
+
+// Give every idle core something to run, stealing when its own queue is empty.
+// Return the number of busy cores
+static int dispatchIdleCores(Simulation *simulation) {
+    int busyCores = 0;
+
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        runQueueTick(&core->runQueue, simulation->stats.simulationTime);
+
+        // Under arrival preemption a process that does not fit goes round the queue once
+        // before it waits for memory, as the reference loop cycles through its ready queue
+        int rotations = simulation->arrivalPreemption ? runQueueCount(&core->runQueue) : 0;
+        int rotated = 0;
+        while (!core->currentProcess) {
+            Process *next = pickFromRunQueue(&core->runQueue);
+            if (!next) {
+                next = stealProcess(simulation, core);
+            }
+            if (!next) {
+                break;
+            }
+            int wasResident = next->isAllocated;
+            int blocked;
+            if (!loadOnCore(simulation, i, next, &blocked)) {
+                if (rotations-- > 0) {
+                    addToRunQueue(&core->runQueue, next);
+                    rotated = 1;
+                } else {
+                    changeState(simulation, next, WAITING);
+                    enqueue(simulation->memoryWaitQueue, next);
+                }
+                continue;
+            }
+            if (!blocked) {
+                // Coming back round the queue, as it does there, it is announced again
+                startSlice(simulation, i, next, wasResident, rotated ? NULL : core->previousProcess);
+            }
+        }
+        if (core->currentProcess) {
+            busyCores++;
+        }
+    }
+    return busyCores;
+}
+
+// End the slice of the process running on core cpu, leaving the core idle
+static Process* endSlice(Simulation *simulation, int cpu) {
+    Core *core = &simulation->cores[cpu];
+    Process *process = core->currentProcess;
+    process->remainingTime -= core->runTime;
+    process->vruntime += core->runTime;
+    process->lastUsed = simulation->stats.simulationTime;
+    core->currentProcess = NULL;
+    if (simulation->trace) {
+        traceRunSlice(simulation->trace, cpu, process, core->sliceStart, core->sliceEnd);
+    }
+    return process;
+}
+
+// Finish the slices that end at the current time
+static void completeSlices(Simulation *simulation) {
+    SchedulerStats *stats = &simulation->stats;
+    int cpuField = simulation->numCores > 1;
+
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        if (!core->currentProcess || core->sliceEnd != stats->simulationTime) {
+            continue;
+        }
+        Process *currentProcess = endSlice(simulation, i);
+
+        if (currentProcess->remainingTime <= 0) {
+            PROFILE_BEGIN(PHASE_ALLOCATION);
+            releaseProcess(&simulation->memory, currentProcess, stats->simulationTime);
+            PROFILE_END();
+            simulation->activeWorkingSet -= workingSetSize(currentProcess);
+            invalidateTranslations(simulation, currentProcess);
+            wakeMemoryWaiters(simulation);
+
+            changeState(simulation, currentProcess, FINISHED);
+            printFinishedEvent(simulation->options.output, currentProcess, stats->simulationTime, readyCount(simulation), cpuField ? i : -1);
+            if (simulation->memory.demandPaging) {
+                printEvent(simulation->options.output, "%d,PAGE-FAULTS,process-name=%s,page-faults=%ld,references=%ld\n",
+                           stats->simulationTime, currentProcess->name, currentProcess->pageFaults, currentProcess->pageReferences);
+            }
+            recordFinishedProcess(stats, currentProcess);
+            // No core may take a later process at the same address for this one
+            for (int j = 0; j < simulation->numCores; j++) {
+                if (simulation->cores[j].previousProcess == currentProcess) {
+                    simulation->cores[j].previousProcess = NULL;
+                }
+            }
+            freeProcess(currentProcess);
+            core->previousProcess = NULL;
+        } else if (suspendIfOverloaded(simulation, currentProcess)) {
+            core->previousProcess = NULL;
+        } else {
+            changeState(simulation, currentProcess, READY);
+            requeueProcess(&core->runQueue, currentProcess);
+            core->previousProcess = currentProcess;
+        }
+    }
+}
+
+// Admit the processes that have arrived by now. Under arrival preemption, arrivals that
+// find nothing queued meet the process on the core the way the reference loop lets
+// them: the first one takes the core and the process it took it from queues first.
+// First-fit memory is given to each of them as it arrives, and one that gets none
+// queues without taking the core
+static void admitArrivalsPreempting(Simulation *simulation) {
+    Queue *allProcesses = simulation->allProcesses;
+    Core *core = &simulation->cores[0];
+    int now = simulation->stats.simulationTime;
+    refillArrivals(simulation);
+    // Only a core that is idle, or whose process runs on past the slice ending now, is met
+    if (!simulation->arrivalPreemption || isQueueEmpty(allProcesses) || peek(allProcesses)->arrivalTime > now ||
+        runQueueCount(&core->runQueue) > 0 ||
+        (core->currentProcess && (core->sliceEnd != now || core->currentProcess->remainingTime <= core->runTime))) {
+        admitArrivals(simulation);
+        return;
+    }
+
+    PROFILE_BEGIN(PHASE_ARRIVAL);
+    Queue *queue = core->runQueue.fifo;
+    Process *runner = NULL;
+    if (core->currentProcess) {
+        runner = endSlice(simulation, 0);
+        changeState(simulation, runner, READY);
+        core->previousProcess = runner;
+    }
+    while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= now) {
+        Process *newProcess = dequeue(allProcesses);
+        refillArrivals(simulation);
+        if (simulation->trace) {
+            traceProcessTrack(simulation->trace, newProcess);
+        }
+        changeState(simulation, newProcess, READY);
+        int blocked = 0;
+        if (simulation->memory.strategy == FIRST_FIT && !loadOnCore(simulation, 0, newProcess, &blocked)) {
+            enqueue(queue, newProcess);
+            continue;
+        }
+        if (blocked) {
+            continue;
+        }
+        // One arriving together with the process that has the core does not take it
+        if (isQueueEmpty(queue) && (!runner || newProcess->arrivalTime != runner->arrivalTime)) {
+            if (runner) {
+                enqueue(queue, runner);
+            }
+            runner = newProcess;
+            printRunningEvent(simulation->options.output, &simulation->memory, runner, now, -1);
+        } else {
+            enqueue(queue, newProcess);
+        }
+    }
+    PROFILE_END();
+
+    if (!runner) {
+        return;
+    }
+    int wasResident = runner->isAllocated;
+    int blocked;
+    if (!loadOnCore(simulation, 0, runner, &blocked)) {
+        changeState(simulation, runner, WAITING);
+        enqueue(simulation->memoryWaitQueue, runner);
+    } else if (!blocked) {
+        startSlice(simulation, 0, runner, wasResident, runner);
+    }
+}
+
+// One scheduling event, never moving past limit. Return 1 if time moved or
+// something ran, 0 if there is nothing to do before limit
+static int stepUntil(Simulation *simulation, int limit) {
+    SchedulerStats *stats = &simulation->stats;
+
+    admitArrivalsPreempting(simulation);
+    wakeBlockedProcesses(simulation);
+    resumeSuspended(simulation);
+    PROFILE_BEGIN(PHASE_DISPATCH);
+    int busyCores = dispatchIdleCores(simulation);
+    PROFILE_END();
+    traceMemoryChanges(simulation);
+
+    // Nothing can run, jump to the next arrival or the end of the next swap I/O
+    if (busyCores == 0) {
+        int nextEvent = nextWakeTime(simulation);
+        if (!isQueueEmpty(simulation->allProcesses) && peek(simulation->allProcesses)->arrivalTime < nextEvent) {
+            nextEvent = peek(simulation->allProcesses)->arrivalTime;
+        }
+        if (nextEvent == INT_MAX) {
+            return 0;
+        }
+        // An idle round robin core only looks again after each quantum, like the reference loop
+        if (simulation->options.policy == ROUND_ROBIN) {
+            int quanta = (nextEvent - stats->simulationTime + simulation->quantum - 1) / simulation->quantum;
+            nextEvent = stats->simulationTime + quanta * simulation->quantum;
+        }
+        if (nextEvent > limit) {
+            return 0;
+        }
+        stats->simulationTime = nextEvent;
+        simulation->events++;
+        return 1;
+    }
+
+    // Advance to the earliest end of a slice or swap I/O
+    int nextEvent = nextWakeTime(simulation);
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        if (core->currentProcess && core->sliceEnd < nextEvent) {
+            nextEvent = core->sliceEnd;
+        }
+    }
+    if (nextEvent > limit) {
+        return 0;
+    }
+    stats->simulationTime = nextEvent;
+
+    admitArrivalsPreempting(simulation);
+    completeSlices(simulation);
+    wakeBlockedProcesses(simulation);
+    resumeSuspended(simulation);
+    backgroundReclaim(simulation);
+    traceMemoryChanges(simulation);
+    simulation->events++;
+    return 1;
+}
+
+int stepSimulation(Simulation *simulation) {
+    // A step that cannot move time or run anything will never finish the rest
+    return stepUntil(simulation, INT_MAX) && !isSimulationFinished(simulation);
+}
+
+int runSimulationUntil(Simulation *simulation, int time) {
+    while (stepUntil(simulation, time)) {
+    }
+    return simulation->stats.simulationTime;
+}
+
+// Processes still to arrive, run or wait for swap I/O. The ones waiting for memory are
+// left out, once nothing else is left they need more than exists
+static long unfinishedCount(Simulation *simulation) {
+    const Workload *workload = simulation->options.workload;
+    long count = simulation->allProcesses->count + simulation->blockedQueue->count + simulation->suspendedQueue->count;
+    if (workload) {
+        count += workload->count - simulation->workloadNext;
+    }
+    for (int i = 0; i < simulation->numCores; i++) {
+        count += coreLoad(&simulation->cores[i]);
+    }
+    return count;
+}
+
+int isSimulationFinished(Simulation *simulation) {
+    return unfinishedCount(simulation) == 0;
+}
+
+void getSimulationStats(Simulation *simulation, SchedulerStats *stats) {
+    *stats = simulation->stats;
+    stats->memoryWaiting = simulation->memoryWaitQueue->count;
+    // Frame counters live in the frame table, which only the paged strategies set up
+    if (simulation->memory.strategy == PAGED || simulation->memory.strategy == VIRTUAL) {
+        FrameTable *table = &simulation->memory.frameTable;
+        stats->pagesMapped = table->pagesMapped;
+        stats->hugePagesMapped = table->hugePagesMapped;
+        stats->hugeWasteFrames = table->hugeWasteFrames;
+        stats->hugeFallbacks = table->hugeFallbacks;
+        stats->hugeSplits = table->hugeSplits;
+        stats->framesEvicted = table->framesSwappedOut;
+        stats->sharedPagesMapped = table->sharedPagesMapped;
+        stats->sharedFramesReused = table->sharedFramesReused;
+        stats->cowCopies = table->cowCopies;
+        stats->peakPhysicalKB = table->peakFramesUsed * PAGE_SIZE;
+        stats->peakVirtualKB = table->peakPagesMapped * PAGE_SIZE;
+        for (int i = 0; i < MAX_MEMORY_GROUPS; i++) {
+            MemoryGroup *group = &table->groups[i];
+            stats->groups[i].used = group->used;
+            stats->groups[i].limitKB = group->limitFrames * PAGE_SIZE;
+            stats->groups[i].peakKB = group->peakFrames * PAGE_SIZE;
+            stats->groups[i].framesEvicted = group->framesEvicted;
+            stats->groups[i].reclaims = group->reclaims;
+            stats->groupCount += group->used;
+        }
+    }
+    stats->numaNodes = simulation->numaEnabled ? simulation->memory.numaNodes : 0;
+    stats->pagesMigrated = simulation->memory.pagesMigrated;
+    for (int i = 0; i < stats->numaNodes; i++) {
+        stats->nodePeakKB[i] = simulation->memory.nodePeakKB[i];
+    }
+    if (simulation->memory.strategy == PAGED || simulation->memory.strategy == VIRTUAL) {
+        stats->pagesMigrated += simulation->memory.frameTable.pagesMigrated;
+        for (int i = 0; i < stats->numaNodes; i++) {
+            stats->nodePeakKB[i] = simulation->memory.frameTable.nodePeakFrames[i] * PAGE_SIZE;
+        }
+    }
+    if (simulation->memory.memoryManager) {
+        stats->peakHoleCount = simulation->memory.memoryManager->peakHoleCount;
+    }
+    stats->worstFragmentation = simulation->memory.worstFragmentation;
+    stats->admissionFailures = simulation->memory.admissionFailures;
+    stats->fragmentedFailures = simulation->memory.fragmentedFailures;
+    stats->processSwapOuts = simulation->memory.processSwapOuts;
+    stats->processSwapIns = simulation->memory.processSwapIns;
+    stats->processSwappedOutKB = simulation->memory.swappedOutKB;
+    stats->processSwappedInKB = simulation->memory.swappedInKB;
+}
+
+void destroySimulation(Simulation *simulation) {
+    if (!simulation) {
+        return;
+    }
+    if (simulation->cores) {
+        for (int i = 0; i < simulation->numCores; i++) {
+            Core *core = &simulation->cores[i];
+            if (core->currentProcess) {
+                freeProcess(core->currentProcess);
+            }
+            freeRunQueue(&core->runQueue);
+            freeTlb(&core->tlb);
+        }
+        free(simulation->cores);
+    }
+    if (simulation->allProcesses) {
+        freeQueue(simulation->allProcesses);
+    }
+    if (simulation->memoryWaitQueue) {
+        freeQueue(simulation->memoryWaitQueue);
+    }
+    if (simulation->blockedQueue) {
+        freeQueue(simulation->blockedQueue);
+    }
+    if (simulation->suspendedQueue) {
+        freeQueue(simulation->suspendedQueue);
+    }
+    freeMemoryState(&simulation->memory);
+    if (closeTrace(simulation->trace) != 0) {
+        fprintf(stderr, "Failed to write the trace\n");
+    }
+    free(simulation);
+}
+
+// Layout of a checkpoint, bumped whenever the state it stores changes
+#define CHECKPOINT_VERSION 1
+
+static const char checkpointMagic[8] = "SIMCKPT";
+
+// Header of a checkpoint: its format, the build that wrote it and the settings of the
+// run. Return 0 if this build can restore it
+static int checkpointSettings(Checkpoint *checkpoint, int *quantum, MemoryStrategy *strategy, SchedulerOptions *options) {
+    char magic[sizeof(checkpointMagic)];
+    int layout[4] = {CHECKPOINT_VERSION, sizeof(Process), sizeof(SchedulerOptions), sizeof(SchedulerStats)};
+    int expected[4] = {CHECKPOINT_VERSION, sizeof(Process), sizeof(SchedulerOptions), sizeof(SchedulerStats)};
+    memcpy(magic, checkpointMagic, sizeof(magic));
+    checkpointBytes(checkpoint, magic, sizeof(magic));
+    checkpointBytes(checkpoint, layout, sizeof(layout));
+    checkpointInt(checkpoint, quantum);
+    checkpointBytes(checkpoint, strategy, sizeof(*strategy));
+    checkpointBytes(checkpoint, options, sizeof(*options));
+    if (checkpoint->failed || memcmp(magic, checkpointMagic, sizeof(magic)) != 0 || memcmp(layout, expected, sizeof(layout)) != 0) {
+        checkpoint->failed = true;
+        return -1;
+    }
+    return 0;
+}
+
+// Options that belong to the run restoring a checkpoint rather than to the checkpoint:
+// where output goes and what else is reported or saved
+static void keepRunOptions(SchedulerOptions *restored, const SchedulerOptions *options) {
+    restored->output = options->output;
+    restored->profile = options->profile;
+    restored->tracePath = options->tracePath;
+    restored->latencyPercentiles = options->latencyPercentiles;
+    restored->checkpointPath = options->checkpointPath;
+    restored->checkpointTime = options->checkpointTime;
+    restored->checkpointEvents = options->checkpointEvents;
+    restored->checkpointStop = options->checkpointStop;
+    restored->restorePath = options->restorePath;
+    restored->workload = options->workload;
+}
+
+static void checkpointRunQueue(Checkpoint *checkpoint, RunQueue *runQueue) {
+    if (runQueue->policy == FAIR) {
+        checkpointFairQueue(checkpoint, runQueue->fair);
+    } else if (runQueue->policy == FEEDBACK) {
+        checkpointFeedbackQueue(checkpoint, runQueue->feedback);
+    } else {
+        checkpointQueue(checkpoint, runQueue->fifo);
+    }
+    checkpointInt(checkpoint, &runQueue->nextBoost);
+}
+
+// Everything but the processes that have not arrived, which come from the input again.
+// Every admitted process sits on a core, in a run queue or in one of the waiting queues,
+// so those are stored first and everything else refers to processes stored there
+static void checkpointState(Checkpoint *checkpoint, Simulation *simulation) {
+    int inputOffset = simulation->processCount - simulation->allProcesses->count;
+    checkpointInt(checkpoint, &inputOffset);
+    if (!checkpoint->saving) {
+        simulation->processCount = inputOffset;
+        simulation->workloadNext = inputOffset;
+    }
+    checkpointLong(checkpoint, &simulation->events);
+    checkpointLong(checkpoint, &simulation->activeWorkingSet);
+    checkpointBytes(checkpoint, &simulation->swapDevice, sizeof(SwapDevice));
+    checkpointBytes(checkpoint, &simulation->stats, sizeof(SchedulerStats));
+
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        core->currentProcess = checkpointProcess(checkpoint, core->currentProcess);
+        checkpointRunQueue(checkpoint, &core->runQueue);
+    }
+    checkpointQueue(checkpoint, simulation->memoryWaitQueue);
+    checkpointQueue(checkpoint, simulation->blockedQueue);
+    checkpointQueue(checkpoint, simulation->suspendedQueue);
+
+    for (int i = 0; i < simulation->numCores; i++) {
+        Core *core = &simulation->cores[i];
+        // It may have finished on another core since
+        core->previousProcess = checkpointProcessReference(checkpoint, core->previousProcess);
+        checkpointInt(checkpoint, &core->sliceStart);
+        checkpointInt(checkpoint, &core->sliceEnd);
+        checkpointInt(checkpoint, &core->runTime);
+        checkpointLong(checkpoint, &core->tlbCycles);
+        checkpointLong(checkpoint, &core->faultCycles);
+        checkpointLong(checkpoint, &core->numaCycles);
+        if (simulation->tlbEnabled) {
+            checkpointTlb(checkpoint, &core->tlb);
+        }
+    }
+    checkpointMemoryState(checkpoint, &simulation->memory);
+}
+
+int saveSimulation(Simulation *simulation, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+    Checkpoint checkpoint;
+    openCheckpoint(&checkpoint, file, true);
+    MemoryStrategy strategy = simulation->memory.strategy;
+    checkpointSettings(&checkpoint, &simulation->quantum, &strategy, &simulation->options);
+    checkpointState(&checkpoint, simulation);
+    int failed = closeCheckpoint(&checkpoint) != 0;
+    failed |= fclose(file) != 0;
+    return failed ? -1 : 0;
+}
+
+int readCheckpointSettings(const char *path, int *quantum, MemoryStrategy *strategy, SchedulerOptions *options) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    Checkpoint checkpoint;
+    openCheckpoint(&checkpoint, file, false);
+    SchedulerOptions restored;
+    int result = checkpointSettings(&checkpoint, quantum, strategy, &restored);
+    closeCheckpoint(&checkpoint);
+    fclose(file);
+    if (result == 0) {
+        keepRunOptions(&restored, options);
+        *options = restored;
+    }
+    return result;
+}
+
+Simulation* restoreSimulation(const char *path, SchedulerOptions *options) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    Checkpoint checkpoint;
+    openCheckpoint(&checkpoint, file, false);
+    int quantum;
+    MemoryStrategy strategy;
+    SchedulerOptions restored;
+    Simulation *simulation = NULL;
+    if (checkpointSettings(&checkpoint, &quantum, &strategy, &restored) == 0) {
+        keepRunOptions(&restored, options);
+        simulation = createSimulation(quantum, strategy, &restored);
+    }
+    if (simulation) {
+        checkpointState(&checkpoint, simulation);
+        // A trace of the restored run starts with the processes already admitted
+        for (int i = 0; simulation->trace && !checkpoint.failed && i < checkpoint.processCount; i++) {
+            traceProcessTrack(simulation->trace, checkpoint.processes[i]);
+        }
+        simulation->tracedFrames = simulation->memory.frameTable.framesSwappedOut;
+        simulation->tracedSwappedOutKB = simulation->memory.swappedOutKB;
+    }
+    int failed = closeCheckpoint(&checkpoint) != 0;
+    fclose(file);
+    if (failed) {
+        destroySimulation(simulation);
+        return NULL;
+    }
+    return simulation;
+}
+
+int simulationInputOffset(Simulation *simulation) {
+    return simulation->processCount - simulation->allProcesses->count;
+}
+
+// Take over the queued input processes, numbering them in input order. The first skip
+// of them were admitted before the checkpoint a restored simulation started from
+static void takeProcesses(Simulation *simulation, Queue *allProcesses, int skip) {
+    for (; skip > 0 && !isQueueEmpty(allProcesses); skip--) {
+        freeProcess(dequeue(allProcesses));
+    }
+    for (Node *node = allProcesses->front; node; node = node->next) {
+        node->data->id = simulation->processCount++;
+    }
+    appendQueue(simulation->allProcesses, allProcesses);
+}
+
+// Step to the first event at or after the checkpoint time, or through the checkpoint
+// number of events. Stopping between events keeps a restored run identical to one
+// that never stopped
+static void runToCheckpoint(Simulation *simulation) {
+    SchedulerOptions *options = &simulation->options;
+    while (options->checkpointTime >= 0 ? simulation->stats.simulationTime < options->checkpointTime
+                                        : simulation->events < options->checkpointEvents) {
+        if (!stepSimulation(simulation)) {
+            break;
+        }
+    }
+}
+
+// Scheduling loop shared by every policy once the round robin reference loop does
+// not apply. Each core runs its own run queue; the queue decides which process runs
+// next and for how long. Round robin is charged in whole quanta and lets arrivals
+// preempt as in the reference loop
+void runPolicyScheduling(Queue *allProcesses, int quantum, MemoryStrategy strategy, SchedulerOptions *options, SchedulerStats *stats) {
+    memset(stats, 0, sizeof(SchedulerStats));
+
+    Simulation *simulation;
+    if (options->restorePath) {
+        simulation = restoreSimulation(options->restorePath, options);
+        if (!simulation) {
+            fprintf(stderr, "Failed to restore the checkpoint\n");
+            return;
+        }
+    } else if (!(simulation = createSimulation(quantum, strategy, options))) {
+        fprintf(stderr, "Failed to create the simulation\n");
+        return;
+    }
+
+    // The simulation takes over every queued process it has not admitted yet
+    takeProcesses(simulation, allProcesses, simulationInputOffset(simulation));
+    if (options->checkpointPath) {
+        runToCheckpoint(simulation);
+        if (saveSimulation(simulation, options->checkpointPath) != 0) {
+            fprintf(stderr, "Failed to write the checkpoint\n");
+        } else if (options->checkpointStop) {
+            destroySimulation(simulation);
+            return;
+        }
+    }
+    while (stepSimulation(simulation)) {
+    }
+
+    getSimulationStats(simulation, stats);
+    // Stopped without finishing, nothing left could run again
+    stats->unfinished = unfinishedCount(simulation);
+    if (stats->unfinished > 0) {
+        fprintf(stderr, "Simulation stuck at time %d with %ld processes unfinished\n", stats->simulationTime, stats->unfinished);
+    } else if (stats->memoryWaiting > 0) {
+        // Anything still waiting needs more memory than exists
+        fprintf(stderr, "%d processes can never be allocated memory\n", stats->memoryWaiting);
+    }
+    destroySimulation(simulation);
+}
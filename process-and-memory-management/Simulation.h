@@ -0,0 +1,60 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Scheduler.h"
+
+// Opaque handle to one simulation. Every simulation owns all of its state, so
+// independent simulations can be driven from different threads
+typedef struct Simulation Simulation;
+
+// Create an empty simulation. Events go to options->output, NULL keeps it quiet. With
+// options->workload set, its processes are created as the simulation reaches each arrival
+Simulation* createSimulation(int quantum, MemoryStrategy strategy, SchedulerOptions *options);
+
+// Add a process. Processes must be added in order of arrival time, and none may arrive
+// before the current simulation time. Return 0 on success, -1 if the arrival is out of
+// order or memory ran out
+int addProcess(Simulation *simulation, const char *name, int arrivalTime, int serviceTime, int memoryRequirement);
+
+// Add a process with the optional columns of the input format after its memory
+// requirement: a page reference pattern, shared:<id>:<size in KB> and
+// group:<id>[:<limit in KB>], separated by blanks. NULL adds none, like addProcess.
+// Return -1 as addProcess does, or if a column is malformed
+int addProcessWithColumns(Simulation *simulation, const char *name, int arrivalTime, int serviceTime, int memoryRequirement,
+                          const char *columns);
+
+// Advance to the next scheduling event. Return 1 if there is more to simulate, 0 once
+// finished or when nothing left can ever run again
+int stepSimulation(Simulation *simulation);
+
+// Step through every event up to and including the given time, never completing
+// an event scheduled after it. Return the time of the last event processed
+int runSimulationUntil(Simulation *simulation, int time);
+
+// Return 1 when there is nothing left to arrive, run or wait for swap I/O. Processes
+// still waiting for memory then need more than exists and never run, getSimulationStats
+// counts them in memoryWaiting
+int isSimulationFinished(Simulation *simulation);
+
+// Copy the statistics so far; simulationTime is the makespan once finished
+void getSimulationStats(Simulation *simulation, SchedulerStats *stats);
+
+void destroySimulation(Simulation *simulation);
+
+// Write the whole state to path as a binary checkpoint. Processes that have not arrived
+// are left out, a restore takes them from the input again. Return 0 on success
+int saveSimulation(Simulation *simulation, const char *path);
+
+// Read the quantum, memory strategy and options a checkpoint was saved with. Output,
+// tracing, reporting and checkpoint options are kept from options. Return 0 on success
+int readCheckpointSettings(const char *path, int *quantum, MemoryStrategy *strategy, SchedulerOptions *options);
+
+// Continue from a checkpoint, with the settings readCheckpointSettings gives.
+// Return NULL if it cannot be read or was written by a different build
+Simulation* restoreSimulation(const char *path, SchedulerOptions *options);
+
+// Number of processes of the input admitted so far. A restored simulation expects the
+// same input again and only takes the processes after these
+int simulationInputOffset(Simulation *simulation);
+
+#endif
@@ -0,0 +1,30 @@
+#include "SwapDevice.h"
+
+int initializeSwapDevice(SwapDevice *device, int latency, int bandwidth, int queueDepth) {
+    if (latency < 0 || bandwidth < 1 || queueDepth < 1 || queueDepth > SWAP_MAX_QUEUE_DEPTH) {
+        return -1;
+    }
+    device->latency = latency;
+    device->bandwidth = bandwidth;
+    device->queueDepth = queueDepth;
+    for (int i = 0; i < queueDepth; i++) {
+        device->busyUntil[i] = 0;
+    }
+    return 0;
+}
+
+// Queue a transfer of size KB issued at simulationTime and return the time it completes.
+// The request takes whichever service slot frees up first
+int submitSwapRequest(SwapDevice *device, int size, int simulationTime) {
+    int slot = 0;
+    for (int i = 1; i < device->queueDepth; i++) {
+        if (device->busyUntil[i] < device->busyUntil[slot]) {
+            slot = i;
+        }
+    }
+
+    int start = device->busyUntil[slot] > simulationTime ? device->busyUntil[slot] : simulationTime;
+    int transferTime = (size + device->bandwidth - 1) / device->bandwidth;
+    device->busyUntil[slot] = start + device->latency + transferTime;
+    return device->busyUntil[slot];
+}
@@ -0,0 +1,19 @@
+#ifndef SWAP_DEVICE_H
+#define SWAP_DEVICE_H
+
+// Maximum number of requests a swap device services at once
+#define SWAP_MAX_QUEUE_DEPTH 64
+
+// Backing store for evicted pages. A request waits for a free service slot, then
+// takes the fixed latency plus its size over the bandwidth
+typedef struct {
+    int latency; // Time before a request starts moving data
+    int bandwidth; // KB moved per unit of time
+    int queueDepth; // Requests serviced concurrently
+    int busyUntil[SWAP_MAX_QUEUE_DEPTH]; // Time each service slot becomes free
+} SwapDevice;
+
+int initializeSwapDevice(SwapDevice *device, int latency, int bandwidth, int queueDepth);
+int submitSwapRequest(SwapDevice *device, int size, int simulationTime);
+
+#endif
@@ -0,0 +1,184 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Sweep.h"
+
+static const char *strategyNames[] = {
+    "infinite",  // Corresponds to INFINITE
+    "first-fit", // Corresponds to FIRST_FIT
+    "paged",     // Corresponds to PAGED
+    "virtual"    // Corresponds to VIRTUAL
+};
+
+// One point of the sweep and its result
+typedef struct {
+    int quantum; // Quantum of this configuration
+    MemoryStrategy strategy; // Memory strategy of this configuration
+    SchedulerStats stats; // Statistics once simulated
+    int failed; // Set when its copy of the input could not be made
+} SweepPoint;
+
+// State shared by the worker threads
+typedef struct {
+    Queue *allProcesses; // Parsed input, only ever read by the workers
+    SchedulerOptions *options; // Scheduler options common to every point
+    SweepPoint *points; // Configurations to simulate
+    int numPoints; // Number of configurations
+    int nextPoint; // Next configuration nobody has claimed yet
+    pthread_mutex_t lock; // Protects nextPoint
+} SweepContext;
+
+void initializeSweepOptions(SweepOptions *sweep) {
+    sweep->numQuanta = 0;
+    sweep->numStrategies = 0;
+    sweep->threads = 0;
+}
+
+// Parse a list such as "1,2,5-10" into the quanta to sweep. Return 0 on success, -1 otherwise
+int parseQuantumList(SweepOptions *sweep, const char *list) {
+    const char *current = list;
+    while (*current) {
+        char *end;
+        long first = strtol(current, &end, 10);
+        long last = first;
+        if (end == current) {
+            return -1;
+        }
+        if (*end == '-') {
+            current = end + 1;
+            last = strtol(current, &end, 10);
+            if (end == current) {
+                return -1;
+            }
+        }
+        if (first < 1 || last < first) {
+            return -1;
+        }
+        for (long quantum = first; quantum <= last; quantum++) {
+            if (sweep->numQuanta == SWEEP_MAX_QUANTA) {
+                return -1;
+            }
+            sweep->quanta[sweep->numQuanta++] = (int)quantum;
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return -1;
+        }
+        current = end;
+    }
+    return sweep->numQuanta > 0 ? 0 : -1;
+}
+
+// Every simulation gets its own copy of the input, so the shared queue is never modified
+static void *sweepWorker(void *argument) {
+    SweepContext *context = (SweepContext *)argument;
+    SchedulerOptions options = *context->options;
+    options.output = NULL;
+
+    while (true) {
+        pthread_mutex_lock(&context->lock);
+        int index = context->nextPoint++;
+        pthread_mutex_unlock(&context->lock);
+        if (index >= context->numPoints) {
+            break;
+        }
+
+        SweepPoint *point = &context->points[index];
+        Queue *processes = copyQueue(context->allProcesses);
+        if (!processes) {
+            point->failed = 1;
+            continue;
+        }
+        runScheduling(processes, point->quantum, point->strategy, &options, &point->stats);
+        freeQueue(processes);
+    }
+    return NULL;
+}
+
+// Simulate every (quantum, strategy) pair on a pool of threads and print one
+// summary row per pair, in the order the pairs were given
+int runSweep(Queue *allProcesses, SweepOptions *sweep, SchedulerOptions *options, FILE *output) {
+    SweepContext context;
+    context.allProcesses = allProcesses;
+    context.options = options;
+    context.numPoints = sweep->numQuanta * sweep->numStrategies;
+    context.nextPoint = 0;
+    context.points = (SweepPoint *)calloc(context.numPoints, sizeof(SweepPoint));
+    if (!context.points) {
+        return -1;
+    }
+    for (int i = 0; i < sweep->numQuanta; i++) {
+        for (int j = 0; j < sweep->numStrategies; j++) {
+            SweepPoint *point = &context.points[i * sweep->numStrategies + j];
+            point->quantum = sweep->quanta[i];
+            point->strategy = sweep->strategies[j];
+        }
+    }
+    pthread_mutex_init(&context.lock, NULL);
+
+    int numThreads = sweep->threads;
+    if (numThreads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = online > 0 ? (int)online : 1;
+    }
+    if (numThreads > context.numPoints) {
+        numThreads = context.numPoints;
+    }
+
+    pthread_t *threads = (pthread_t *)malloc(numThreads * sizeof(pthread_t));
+    if (!threads) {
+        pthread_mutex_destroy(&context.lock);
+        free(context.points);
+        return -1;
+    }
+    int started = 0;
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&threads[i], NULL, sweepWorker, &context) == 0) {
+            started++;
+        }
+    }
+    // Fall back to the calling thread if no worker could be started
+    if (started == 0) {
+        sweepWorker(&context);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // A point that was not simulated has no row to give, the sweep fails instead
+    int failed = 0;
+    for (int i = 0; i < context.numPoints; i++) {
+        SweepPoint *point = &context.points[i];
+        if (point->failed) {
+            fprintf(stderr, "Failed to copy the input for quantum %d and %s memory\n", point->quantum, strategyNames[point->strategy]);
+            failed = 1;
+        }
+    }
+    if (!failed) {
+        fprintf(output, "quantum,memory-strategy,turnaround-time,max-time-overhead,avg-time-overhead,makespan,switch-overhead\n");
+        for (int i = 0; i < context.numPoints; i++) {
+            SweepPoint *point = &context.points[i];
+            if (point->stats.numberOfProcesses == 0) {
+                fprintf(output, "%d,%s,,,,%d,%ld\n", point->quantum, strategyNames[point->strategy], point->stats.simulationTime, point->stats.switchOverhead);
+                continue;
+            }
+            fprintf(output, "%d,%s,%d,%.2f,%.2f,%d,%ld\n",
+                point->quantum,
+                strategyNames[point->strategy],
+                averageTurnaroundTime(&point->stats),
+                point->stats.maxTimeOverhead,
+                averageTimeOverhead(&point->stats),
+                point->stats.simulationTime,
+                point->stats.switchOverhead);
+        }
+    }
+
+    free(threads);
+    pthread_mutex_destroy(&context.lock);
+    free(context.points);
+    return failed ? -1 : 0;
+}
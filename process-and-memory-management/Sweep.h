@@ -0,0 +1,24 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+
+#include "Queue.h"
+#include "Scheduler.h"
+
+#define SWEEP_MAX_QUANTA 1024
+
+// Grid of configurations to simulate over the same input
+typedef struct {
+    int quanta[SWEEP_MAX_QUANTA]; // Quanta to try
+    int numQuanta; // Number of quanta to try
+    MemoryStrategy strategies[4]; // Memory strategies to try
+    int numStrategies; // Number of memory strategies to try
+    int threads; // Worker threads, 0 uses one per online CPU
+} SweepOptions;
+
+void initializeSweepOptions(SweepOptions *sweep);
+int parseQuantumList(SweepOptions *sweep, const char *list);
+int runSweep(Queue *allProcesses, SweepOptions *sweep, SchedulerOptions *options, FILE *output);
+
+#endif
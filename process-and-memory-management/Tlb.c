@@ -0,0 +1,90 @@
+#include <stdlib.h>
+
+#include "Tlb.h"
+
+int initializeTlb(Tlb *tlb, int entries, int ways, TlbReplacement replacement, bool tagged) {
+    if (entries < 1 || ways < 1 || entries % ways != 0) {
+        return -1;
+    }
+    tlb->entries = (TlbEntry *)calloc(entries, sizeof(TlbEntry));
+    if (!tlb->entries) {
+        return -1;
+    }
+    tlb->sets = entries / ways;
+    tlb->ways = ways;
+    tlb->replacement = replacement;
+    tlb->tagged = tagged;
+    tlb->currentOwner = NULL;
+    tlb->clock = 0;
+    tlb->seed = 1;
+    tlb->hits = 0;
+    tlb->misses = 0;
+    return 0;
+}
+
+void freeTlb(Tlb *tlb) {
+    free(tlb->entries);
+    tlb->entries = NULL;
+}
+
+// Start translating for process, flushing everything unless entries are tagged
+void tlbSwitch(Tlb *tlb, const Process *process) {
+    if (process == tlb->currentOwner) {
+        return;
+    }
+    if (!tlb->tagged) {
+        for (int i = 0; i < tlb->sets * tlb->ways; i++) {
+            tlb->entries[i].valid = false;
+        }
+    }
+    tlb->currentOwner = process;
+}
+
+// Translate page of the current owner. Return true on a hit; a miss fills the
+// translation in, replacing an invalid entry first
+bool tlbLookup(Tlb *tlb, int page) {
+    TlbEntry *set = &tlb->entries[(page % tlb->sets) * tlb->ways];
+    tlb->clock++;
+
+    TlbEntry *victim = &set[0];
+    for (int i = 0; i < tlb->ways; i++) {
+        if (set[i].valid && set[i].page == page && set[i].owner == tlb->currentOwner) {
+            if (tlb->replacement == TLB_LRU) {
+                set[i].stamp = tlb->clock;
+            }
+            tlb->hits++;
+            return true;
+        }
+        if (!set[i].valid) {
+            if (victim->valid) {
+                victim = &set[i];
+            }
+        } else if (victim->valid && set[i].stamp < victim->stamp) {
+            victim = &set[i];
+        }
+    }
+
+    // Every way is valid, pick one at random instead of the oldest
+    if (victim->valid && tlb->replacement == TLB_RANDOM) {
+        tlb->seed = tlb->seed * 1103515245u + 12345u;
+        victim = &set[(tlb->seed >> 16) % tlb->ways];
+    }
+    victim->owner = tlb->currentOwner;
+    victim->page = page;
+    victim->stamp = tlb->clock;
+    victim->valid = true;
+    tlb->misses++;
+    return false;
+}
+
+// Drop every translation of process, whose pages moved or which finished
+void tlbInvalidate(Tlb *tlb, const Process *process) {
+    for (int i = 0; i < tlb->sets * tlb->ways; i++) {
+        if (tlb->entries[i].owner == process) {
+            tlb->entries[i].valid = false;
+        }
+    }
+    if (tlb->currentOwner == process) {
+        tlb->currentOwner = NULL;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdbool.h>
+
+#include "Process.h"
+
+typedef enum {
+    TLB_LRU,
+    TLB_FIFO,
+    TLB_RANDOM
+} TlbReplacement;
+
+typedef struct {
+    const Process *owner; // Address space the translation belongs to
+    int page; // Virtual page number
+    unsigned long stamp; // Last use for LRU, insertion for FIFO
+    bool valid; // Entry holds a translation
+} TlbEntry;
+
+// Set-associative TLB of one core. Without address space tags every switch to
+// another process flushes it
+typedef struct {
+    TlbEntry *entries; // sets * ways entries, one set after another
+    int sets; // Number of sets
+    int ways; // Entries per set
+    TlbReplacement replacement; // Victim choice within a set
+    bool tagged; // Entries carry the owner so switches need no flush
+    const Process *currentOwner; // Address space currently translated
+    unsigned long clock; // Lookup counter for the stamps
+    unsigned int seed; // State of the random replacement
+    long hits; // Lookups found in the TLB
+    long misses; // Lookups that needed a page walk
+} Tlb;
+
+int initializeTlb(Tlb *tlb, int entries, int ways, TlbReplacement replacement, bool tagged);
+void freeTlb(Tlb *tlb);
+void tlbSwitch(Tlb *tlb, const Process *process);
+bool tlbLookup(Tlb *tlb, int page);
+void tlbInvalidate(Tlb *tlb, const Process *process);
+
+#endif
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+
+#include "Trace.h"
+
+// Size of the stdio buffer in front of the trace file
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+// Trace processes the tracks are grouped under
+#define CPU_TRACKS 1
+#define PROCESS_TRACKS 2
+#define MEMORY_TRACKS 3
+
+// Start the next event, the first one needs no separating comma
+static void beginEvent(Trace *trace) {
+    fputs(trace->events++ > 0 ? ",\n" : "\n", trace->file);
+}
+
+// Write name as the body of a JSON string. Process names come from the input file
+static void writeName(Trace *trace, const char *name) {
+    for (const char *c = name; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', trace->file);
+            fputc(*c, trace->file);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(trace->file, "\\u%04x", (unsigned char)*c);
+        } else {
+            fputc(*c, trace->file);
+        }
+    }
+}
+
+static void nameTrack(Trace *trace, int pid, int tid, const char *kind, const char *name) {
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"args\":{\"name\":\"", pid, tid, kind);
+    writeName(trace, name);
+    fputs("\"}}", trace->file);
+}
+
+Trace* openTrace(const char *path, int cores) {
+    Trace *trace = (Trace *)calloc(1, sizeof(Trace));
+    if (!trace) {
+        return NULL;
+    }
+    trace->file = fopen(path, "w");
+    trace->buffer = (char *)malloc(TRACE_BUFFER_SIZE);
+    if (!trace->file || !trace->buffer) {
+        if (trace->file) {
+            fclose(trace->file);
+        }
+        free(trace->buffer);
+        free(trace);
+        return NULL;
+    }
+    setvbuf(trace->file, trace->buffer, _IOFBF, TRACE_BUFFER_SIZE);
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", trace->file);
+    nameTrack(trace, CPU_TRACKS, 0, "process_name", "CPUs");
+    nameTrack(trace, PROCESS_TRACKS, 0, "process_name", "Processes");
+    nameTrack(trace, MEMORY_TRACKS, 0, "process_name", "Memory");
+    for (int cpu = 0; cpu < cores; cpu++) {
+        char name[32];
+        snprintf(name, sizeof(name), "cpu %d", cpu);
+        nameTrack(trace, CPU_TRACKS, cpu, "thread_name", name);
+    }
+    return trace;
+}
+
+void traceProcessTrack(Trace *trace, const Process *process) {
+    nameTrack(trace, PROCESS_TRACKS, process->id, "thread_name", process->name);
+}
+
+void traceRunSlice(Trace *trace, int cpu, const Process *process, int start, int end) {
+    beginEvent(trace);
+    fputs("{\"ph\":\"X\",\"name\":\"", trace->file);
+    writeName(trace, process->name);
+    fprintf(trace->file, "\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"dur\":%d,\"args\":{\"remaining-time\":%d}}",
+            CPU_TRACKS, cpu, start, end - start, process->remainingTime);
+}
+
+void traceStateSlice(Trace *trace, const Process *process, ProcessState state, int start, int end) {
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"dur\":%d}",
+            processStateNames[state], PROCESS_TRACKS, process->id, start, end - start);
+}
+
+void traceMemory(Trace *trace, int time, int usagePercent, const char *freeName, int freeCount) {
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"C\",\"name\":\"mem-usage\",\"pid\":%d,\"ts\":%d,\"args\":{\"percent\":%d}},\n",
+            MEMORY_TRACKS, time, usagePercent);
+    fprintf(trace->file, "{\"ph\":\"C\",\"name\":\"%s\",\"pid\":%d,\"ts\":%d,\"args\":{\"count\":%d}}",
+            freeName, MEMORY_TRACKS, time, freeCount);
+    trace->events++;
+}
+
+void traceEviction(Trace *trace, int time, int cpu, const Process *process, long frames, long swappedOutKB) {
+    beginEvent(trace);
+    if (cpu >= 0) {
+        fprintf(trace->file, "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"EVICTED\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"args\":{\"process-name\":\"",
+                CPU_TRACKS, cpu, time);
+        writeName(trace, process->name);
+        fputs("\",", trace->file);
+    } else {
+        fprintf(trace->file, "{\"ph\":\"i\",\"s\":\"g\",\"name\":\"EVICTED\",\"pid\":%d,\"tid\":0,\"ts\":%d,\"args\":{",
+                MEMORY_TRACKS, time);
+    }
+    fprintf(trace->file, "\"frames\":%ld,\"swapped-out\":%ld}}", frames, swappedOutKB);
+}
+
+int closeTrace(Trace *trace) {
+    if (!trace) {
+        return 0;
+    }
+    fputs("\n]}\n", trace->file);
+    int failed = ferror(trace->file);
+    failed |= fclose(trace->file) != 0;
+    free(trace->buffer);
+    free(trace);
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+#include "Process.h"
+
+// Chrome Trace Event JSON, which Perfetto and chrome://tracing open. Events are
+// streamed through a large buffer as they happen, so memory stays constant however
+// long the run. One unit of simulation time is one microsecond of trace time
+typedef struct {
+    FILE *file; // Trace file being written
+    char *buffer; // stdio buffer of the file
+    long events; // Events written so far
+} Trace;
+
+// Create path and write the header with one track per CPU. Return NULL on failure
+Trace* openTrace(const char *path, int cores);
+
+// Name the track of process after it, once when it arrives
+void traceProcessTrack(Trace *trace, const Process *process);
+
+// process ran on cpu from start to end
+void traceRunSlice(Trace *trace, int cpu, const Process *process, int start, int end);
+
+// process spent start to end in state, on its own track
+void traceStateSlice(Trace *trace, const Process *process, ProcessState state, int start, int end);
+
+// Memory usage in percent and the free frames or holes left, freeName says which
+void traceMemory(Trace *trace, int time, int usagePercent, const char *freeName, int freeCount);
+
+// Frames evicted and KB swapped out whole at time, on the track of cpu or globally when
+// cpu is -1
+void traceEviction(Trace *trace, int time, int cpu, const Process *process, long frames, long swappedOutKB);
+
+// Finish the JSON and close the file. Return 0 if everything was written, -1 otherwise
+int closeTrace(Trace *trace);
+
+#endif
@@ -0,0 +1,54 @@
+#include <stdlib.h>
+
+#include "WorkingSet.h"
+
+WorkingSet* createWorkingSet(int pages, int window) {
+    if (pages < 1 || window < 1) {
+        return NULL;
+    }
+    WorkingSet *workingSet = (WorkingSet *)malloc(sizeof(WorkingSet));
+    if (!workingSet) {
+        return NULL;
+    }
+    workingSet->window = window;
+    workingSet->pages = pages;
+    workingSet->recent = (int *)malloc(window * sizeof(int));
+    workingSet->lastReference = (long *)malloc(pages * sizeof(long));
+    if (!workingSet->recent || !workingSet->lastReference) {
+        freeWorkingSet(workingSet);
+        return NULL;
+    }
+    for (int i = 0; i < pages; i++) {
+        workingSet->lastReference[i] = -1;
+    }
+    workingSet->position = 0;
+    workingSet->size = 0;
+    return workingSet;
+}
+
+// Slide the window one reference forward. The page leaving the window drops out of
+// the working set unless it was referenced again since
+void recordReference(WorkingSet *workingSet, int page) {
+    int slot = (int)(workingSet->position % workingSet->window);
+    if (workingSet->position >= workingSet->window) {
+        int leaving = workingSet->recent[slot];
+        if (workingSet->lastReference[leaving] == workingSet->position - workingSet->window) {
+            workingSet->size--;
+        }
+    }
+
+    if (workingSet->lastReference[page] < 0 || workingSet->lastReference[page] <= workingSet->position - workingSet->window) {
+        workingSet->size++;
+    }
+    workingSet->recent[slot] = page;
+    workingSet->lastReference[page] = workingSet->position;
+    workingSet->position++;
+}
+
+void freeWorkingSet(WorkingSet *workingSet) {
+    if (workingSet) {
+        free(workingSet->recent);
+        free(workingSet->lastReference);
+        free(workingSet);
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef WORKING_SET_H
+#define WORKING_SET_H
+
+// Pages a process referenced within its last window references
+typedef struct {
+    int window; // Length of the sliding window in references
+    int pages; // Pages of the process
+    int *recent; // Ring of the last window pages referenced
+    long *lastReference; // Position of the last reference to each page, -1 if never
+    long position; // References recorded so far
+    int size; // Distinct pages in the window, the working set size
+} WorkingSet;
+
+WorkingSet* createWorkingSet(int pages, int window);
+void recordReference(WorkingSet *workingSet, int page);
+void freeWorkingSet(WorkingSet *workingSet);
+
+#endif
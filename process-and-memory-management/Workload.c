@@ -0,0 +1,118 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Workload.h"
+
+int isWorkloadFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    char magic[sizeof(WORKLOAD_MAGIC)];
+    int found = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return found;
+}
+
+// A column of count 4-byte values at offset lies within the file
+static int columnFits(const Workload *workload, uint64_t offset) {
+    return offset % 4 == 0 && offset <= workload->size && (workload->size - offset) / 4 >= (uint64_t)workload->count;
+}
+
+int openWorkload(Workload *workload, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(WorkloadHeader)) {
+        close(fd);
+        return -1;
+    }
+    workload->size = status.st_size;
+    workload->map = mmap(NULL, workload->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (workload->map == MAP_FAILED) {
+        return -1;
+    }
+    // Columns are read front to back once
+    madvise(workload->map, workload->size, MADV_SEQUENTIAL);
+
+    const WorkloadHeader *header = (const WorkloadHeader *)workload->map;
+    const char *base = (const char *)workload->map;
+    workload->count = (long)header->count;
+    workload->stringsSize = header->stringsSize;
+    if (memcmp(header->magic, WORKLOAD_MAGIC, sizeof(header->magic)) != 0 || header->version != WORKLOAD_VERSION ||
+        header->byteOrder != WORKLOAD_BYTE_ORDER || header->count > (uint64_t)workload->size ||
+        !columnFits(workload, header->arrivalOffset) || !columnFits(workload, header->serviceOffset) ||
+        !columnFits(workload, header->memoryOffset) || !columnFits(workload, header->nameOffset) ||
+        (header->extraColumnsOffset != 0 && !columnFits(workload, header->extraColumnsOffset)) ||
+        header->stringsOffset > workload->size || header->stringsSize > workload->size - header->stringsOffset ||
+        (header->stringsSize > 0 && base[header->stringsOffset + header->stringsSize - 1] != '\0')) {
+        munmap(workload->map, workload->size);
+        return -1;
+    }
+
+    workload->arrival = (const int32_t *)(base + header->arrivalOffset);
+    workload->service = (const int32_t *)(base + header->serviceOffset);
+    workload->memory = (const int32_t *)(base + header->memoryOffset);
+    workload->names = (const uint32_t *)(base + header->nameOffset);
+    workload->extraColumns = header->extraColumnsOffset != 0 ? (const uint32_t *)(base + header->extraColumnsOffset) : NULL;
+    workload->strings = base + header->stringsOffset;
+    return 0;
+}
+
+const char* workloadString(const Workload *workload, uint32_t offset) {
+    // The table ends in a terminator, so any offset inside it starts a terminated string
+    if (offset == WORKLOAD_NO_STRING || offset >= workload->stringsSize) {
+        return NULL;
+    }
+    return workload->strings + offset;
+}
+
+Process* createWorkloadProcess(const Workload *workload, long index) {
+    const char *name = workloadString(workload, workload->names[index]);
+    const char *extra = workload->extraColumns ? workloadString(workload, workload->extraColumns[index]) : NULL;
+    Process *process = name ? (Process *)malloc(sizeof(Process)) : NULL;
+    if (!process) {
+        return NULL;
+    }
+    strncpy(process->name, name, sizeof(process->name) - 1);
+    process->name[sizeof(process->name) - 1] = '\0';
+    process->arrivalTime = workload->arrival[index];
+    process->serviceTime = workload->service[index];
+    process->memoryRequirement = workload->memory[index];
+    initializeInputProcess(process);
+    if (extra) {
+        // Parsed from a copy, the parser cuts the columns apart in place
+        char *columns = strdup(extra);
+        int failed = !columns || parseProcessColumns(process, columns) != 0;
+        free(columns);
+        if (failed) {
+            freeProcess(process);
+            return NULL;
+        }
+    }
+    return process;
+}
+
+int queueWorkloadProcesses(Queue *queue, const Workload *workload) {
+    for (long i = 0; i < workload->count; i++) {
+        Process *process = createWorkloadProcess(workload, i);
+        if (!process) {
+            return -1;
+        }
+        enqueue(queue, process);
+    }
+    return 0;
+}
+
+void closeWorkload(Workload *workload) {
+    munmap(workload->map, workload->size);
+    workload->map = NULL;
+}
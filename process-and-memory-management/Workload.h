@@ -0,0 +1,70 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Process.h"
+#include "Queue.h"
+
+// Binary workload file, written by the convert tool from the text input format. A
+// header is followed by one fixed-width column per field and a string table, laid out
+// so the mapped file is used in place without parsing. Integers are stored in the byte
+// order of the machine that wrote the file
+
+#define WORKLOAD_MAGIC "PMWKLD1"
+#define WORKLOAD_VERSION 1
+// Written as is, reads back differently on a machine of the other byte order
+#define WORKLOAD_BYTE_ORDER 0x01020304u
+// String offset of a process without optional columns
+#define WORKLOAD_NO_STRING 0xffffffffu
+
+typedef struct {
+    char magic[8]; // WORKLOAD_MAGIC with its terminator
+    uint32_t version; // WORKLOAD_VERSION
+    uint32_t byteOrder; // WORKLOAD_BYTE_ORDER
+    uint64_t count; // Processes, the length of every column
+    uint64_t arrivalOffset; // int32_t arrival times, in input order
+    uint64_t serviceOffset; // int32_t service times
+    uint64_t memoryOffset; // int32_t memory requirements in KB
+    uint64_t nameOffset; // uint32_t string offsets of the names
+    uint64_t extraColumnsOffset; // uint32_t string offsets of the optional columns as text, 0 when no process has any
+    uint64_t stringsOffset; // NUL terminated strings
+    uint64_t stringsSize; // Bytes in the string table
+} WorkloadHeader;
+
+// A mapped workload file
+typedef struct {
+    void *map; // The whole file
+    size_t size; // Bytes mapped
+    long count; // Processes
+    const int32_t *arrival; // Arrival time of each process
+    const int32_t *service; // Service time of each process
+    const int32_t *memory; // Memory requirement of each process
+    const uint32_t *names; // String offset of each name
+    const uint32_t *extraColumns; // String offset of each process's optional columns, NULL when there are none
+    const char *strings; // String table
+    uint64_t stringsSize; // Bytes in the string table
+} Workload;
+
+// Return 1 if path starts with the workload magic, 0 for anything else such as text
+int isWorkloadFile(const char *path);
+
+// Map path and check that every column and the string table lie within it.
+// Return 0 on success, -1 if it cannot be mapped or is not a valid workload
+int openWorkload(Workload *workload, const char *path);
+
+// String at offset in the string table, NULL for WORKLOAD_NO_STRING or an offset outside it
+const char* workloadString(const Workload *workload, uint32_t offset);
+
+// Create process index of the workload, parsing only its optional columns.
+// Return NULL if it has no name, a malformed column or memory ran out
+Process* createWorkloadProcess(const Workload *workload, long index);
+
+// Create every process of the workload and add them to queue in order. Return 0 on
+// success, -1 when one cannot be created; the processes before it stay queued
+int queueWorkloadProcesses(Queue *queue, const Workload *workload);
+
+void closeWorkload(Workload *workload);
+
+#endif
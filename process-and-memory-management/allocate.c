@@ -5,576 +5,419 @@
 #include "Queue.h"
 #include "ContiguousMemory.h"
 #include "PagedMemory.h"
-
-// Define an enum for memory strategies
-typedef enum {
-    INFINITE,
-    FIRST_FIT,
-    PAGED,
-    VIRTUAL
-} MemoryStrategy;
+#include "Scheduler.h"
+#include "Simulation.h"
+#include "FeedbackQueue.h"
+#include "Sweep.h"
+#include "Profile.h"
+#include "Workload.h"
 
 
 // Function declarations
-int parseArguments(int argc, char *argv[], char **filename, int *quantum, MemoryStrategy *strategy);
+int parseArguments(int argc, char *argv[], char **filename, int *quantum, MemoryStrategy *strategy, SchedulerOptions *options, SweepOptions *sweep);
+int parseMemoryStrategy(const char *name, MemoryStrategy *strategy);
 Queue* readProcessesFromFile(char *filename);
-void runRoundRobinScheduling(Queue *allProcesses, Queue *queue, int quantum, MemoryStrategy strategy);
-void printProcessStats(Process *process, int simulationTime, Queue *queue);
-int min(int x, int y);
+Queue* readBinaryProcesses(char *filename);
 
 int main(int argc, char *argv[]) {
     char *filename = NULL;
     int quantum = 0;
-    MemoryStrategy strategy;
+    MemoryStrategy strategy = INFINITE;
+    SchedulerOptions options;
+    SweepOptions sweep;
 
-    if (parseArguments(argc, argv, &filename, &quantum, &strategy) != 0) {
+    initializeSchedulerOptions(&options);
+    initializeSweepOptions(&sweep);
+    if (parseArguments(argc, argv, &filename, &quantum, &strategy, &options, &sweep) != 0) {
         fprintf(stderr, "Invalid arguments\n");
         return 1;
     }
 
-    // Store input from file to allProcesses queue
-    Queue *allProcesses = readProcessesFromFile(filename);
+    // Sweep mode: the same input over a grid of quanta and memory strategies
+    if (sweep.numQuanta > 0 || sweep.numStrategies > 0) {
+        if (options.profile || options.tracePath || options.checkpointPath || options.restorePath) {
+            fprintf(stderr, "A sweep cannot be profiled, traced or checkpointed, pick one run\n");
+            return 1;
+        }
+        // Store input from file to allProcesses queue
+        Queue *allProcesses = readProcessesFromFile(filename);
+        if (!allProcesses) {
+            fprintf(stderr, "Failed to read processes from file\n");
+            return 1;
+        }
+        if (sweep.numQuanta == 0) {
+            sweep.quanta[sweep.numQuanta++] = quantum;
+        }
+        if (sweep.numStrategies == 0) {
+            sweep.strategies[sweep.numStrategies++] = strategy;
+        }
+        // Shared segments and memory groups need the paged strategies, as for a single run
+        for (int i = 0; i < sweep.numStrategies; i++) {
+            if (sweep.strategies[i] != PAGED && sweep.strategies[i] != VIRTUAL && hasPagedExtensions(allProcesses, NULL)) {
+                fprintf(stderr, "shared: and group: columns need paged or virtual memory\n");
+                freeQueue(allProcesses);
+                return 1;
+            }
+        }
+        int result = runSweep(allProcesses, &sweep, &options, stdout);
+        freeQueue(allProcesses);
+        return result == 0 ? 0 : 1;
+    }
+
+    // A restored run continues with the quantum, strategy and options it was saved with
+    if (options.restorePath && readCheckpointSettings(options.restorePath, &quantum, &strategy, &options) != 0) {
+        fprintf(stderr, "Failed to read checkpoint %s\n", options.restorePath);
+        return 1;
+    }
+
+    // Translation, huge pages, demand paging and working sets need the page tables only
+    // the paged strategies have, elsewhere they would only report zeros
+    if (strategy != PAGED && strategy != VIRTUAL &&
+        (hasTlb(&options) || hasHugePages(&options) || options.demandPaging || options.workingSetWindow > 0)) {
+        fprintf(stderr, "--tlb-entries, --huge-pages, --demand-paging and --ws-window need paged or virtual memory\n");
+        return 1;
+    }
+    // Only contiguous memory swaps whole processes, the paged strategies evict pages
+    if (strategy != FIRST_FIT && options.processSwapPolicy != SWAP_NONE) {
+        fprintf(stderr, "--swap-policy needs first-fit memory\n");
+        return 1;
+    }
+
+    // A binary workload stays mapped and its processes are only created as they arrive,
+    // a text one is read into the allProcesses queue
+    Workload workload;
+    Queue *allProcesses = NULL;
+    if (isWorkloadFile(filename)) {
+        if (openWorkload(&workload, filename) == 0) {
+            allProcesses = createQueue();
+            options.workload = &workload;
+        } else {
+            fprintf(stderr, "Invalid binary workload %s\n", filename);
+        }
+    } else {
+        allProcesses = readProcessesFromFile(filename);
+    }
     if (!allProcesses) {
         fprintf(stderr, "Failed to read processes from file\n");
         return 1;
     }
+    // Shared segments and memory groups live in the frame table of the paged strategies,
+    // elsewhere they would be ignored
+    if (strategy != PAGED && strategy != VIRTUAL && hasPagedExtensions(allProcesses, options.workload)) {
+        fprintf(stderr, "shared: and group: columns need paged or virtual memory\n");
+        freeQueue(allProcesses);
+        if (options.workload) {
+            closeWorkload(&workload);
+        }
+        return 1;
+    }
 
-    Queue *readyQueue = createQueue();
-    runRoundRobinScheduling(allProcesses, readyQueue, quantum, strategy);
-    freeQueue(readyQueue);
+    SchedulerStats stats;
+    runScheduling(allProcesses, quantum, strategy, &options, &stats);
+    if (stats.invalidInput) {
+        // Found only once the run reached it, the statistics would cover part of the input
+        fprintf(stderr, "Failed to read processes from file\n");
+    } else if (stats.numberOfProcesses > 0 && stats.unfinished == 0) {
+        printStatistics(stdout, &stats);
+        if (hasSwitchCost(&options)) {
+            printSwitchStatistics(stdout, &stats);
+        }
+        if (hasSwapDevice(&options)) {
+            printSwapStatistics(stdout, &stats);
+        }
+        if (hasBackgroundReclaim(&options)) {
+            printReclaimStatistics(stdout, &stats);
+        }
+        if (hasTlb(&options)) {
+            printTlbStatistics(stdout, &stats);
+        }
+        if (hasHugePages(&options)) {
+            printHugePageStatistics(stdout, &stats);
+        }
+        if (options.demandPaging) {
+            printPageFaultStatistics(stdout, &stats);
+        }
+        if (options.processSwapPolicy != SWAP_NONE) {
+            printProcessSwapStatistics(stdout, &stats);
+        }
+        if (stats.sharedPagesMapped > 0) {
+            printSharedMemoryStatistics(stdout, &stats);
+        }
+        if (stats.groupCount > 0) {
+            printGroupStatistics(stdout, &stats);
+        }
+        if (hasNuma(&options)) {
+            printNumaStatistics(stdout, &stats);
+        }
+        if (options.memoryHealth) {
+            printMemoryHealthStatistics(stdout, &stats, strategy);
+        }
+        if (options.workingSetWindow > 0) {
+            printWorkingSetStatistics(stdout, &stats, options.loadControl);
+        }
+        if (options.latencyPercentiles) {
+            printLatencyStatistics(stdout, &stats);
+        }
+    }
     freeQueue(allProcesses);
+    if (options.workload) {
+        closeWorkload(&workload);
+    }
+#ifdef PROFILE
+    if (options.profile) {
+        printProfile(stderr);
+    }
+#endif
 
-    return 0;
+    return stats.invalidInput || stats.unfinished > 0 ? 1 : 0;
 }
 
-int parseArguments(int argc, char *argv[], char **filename, int *quantum, MemoryStrategy *strategy) {
+int parseArguments(int argc, char *argv[], char **filename, int *quantum, MemoryStrategy *strategy, SchedulerOptions *options, SweepOptions *sweep) {
     for (int i = 1; i < argc; i += 2) {
         if (strcmp(argv[i], "-f") == 0) {
             *filename = argv[i + 1];
         } else if (strcmp(argv[i], "-q") == 0) {
             *quantum = atoi(argv[i + 1]);
         } else if (strcmp(argv[i], "-m") == 0) {
-            if (strcmp(argv[i + 1], "infinite") == 0) {
-                *strategy = INFINITE;
-            } else if (strcmp(argv[i + 1], "first-fit") == 0) {
-                *strategy = FIRST_FIT;
-            } else if (strcmp(argv[i + 1], "paged") == 0) {
-                *strategy = PAGED;
-            } else if (strcmp(argv[i + 1], "virtual") == 0) {
-                *strategy = VIRTUAL;
-            } else {
+            if (parseMemoryStrategy(argv[i + 1], strategy) != 0) {
                 fprintf(stderr, "Invalid memory strategy\n");
                 return -1;
             }
-        }
-    }
-    return (*filename && *quantum > 0) ? 0 : -1;
-}
-
-Queue* readProcessesFromFile(char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) return NULL;
-
-    Queue *queue = createQueue();
-    Process *temp;
-
-    while (!feof(file)) {
-        temp = (Process *)malloc(sizeof(Process));
-        if (fscanf(file, "%d %s %d %d", &temp->arrivalTime, temp->name, &temp->serviceTime, &temp->memoryRequirement) == 4) {
-            temp->remainingTime = temp->serviceTime;
-            temp->state = NEW;
-            temp->memoryAddress = -1;
-            temp->isAllocated =false;
-            temp->lastUsed = 0;
-            temp->numFramesAllocated = 0;
-            temp->frameAllocations = NULL; 
-            enqueue(queue, temp);
-        } else {
-            free(temp);
-        }
-    }
-    fclose(file);
-    return queue;
-}
-
-
-
-void runRoundRobinScheduling(Queue *allProcesses, Queue *readyQueue, int quantum, MemoryStrategy strategy) {
-
-    // Handling task 3 and 4
-    if (strategy == VIRTUAL || strategy == PAGED) {
-        int simulationTime = 0;
-        Process *currentProcess = NULL;
-        int totalServiceTime = 0;
-        int numberOfProcesses = 0;
-        double maxTimeOverhead = 0;
-        double totTimeOverhead = 0;
-        bool continuousRunning = false;
-        initializeFrames();
-
-
-        while (!isQueueEmpty(allProcesses) || !isQueueEmpty(readyQueue) || currentProcess != NULL) {
-            // Check for new arrivals and move them to the ready queue or set as current process
-            while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
-                Process *newProcess = dequeue(allProcesses);
-
-                if (currentProcess) {
-                    enqueue(readyQueue, newProcess);
-                    continue;
+        } else if (strcmp(argv[i], "-Q") == 0) {
+            if (parseQuantumList(sweep, argv[i + 1]) != 0) {
+                fprintf(stderr, "Invalid quantum list\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-M") == 0) {
+            // Comma separated memory strategies, each at most once
+            char names[64];
+            strncpy(names, argv[i + 1], sizeof(names) - 1);
+            names[sizeof(names) - 1] = '\0';
+            for (char *name = strtok(names, ","); name; name = strtok(NULL, ",")) {
+                if (sweep->numStrategies == 4 || parseMemoryStrategy(name, &sweep->strategies[sweep->numStrategies]) != 0) {
+                    fprintf(stderr, "Invalid memory strategy list\n");
+                    return -1;
                 }
-
-                // If new process is not allocated before, allocate them
-                if (!newProcess->isAllocated) {
-                    if (strategy == PAGED) {
-                        allocatePages(newProcess, simulationTime);
-                    } else if (strategy == VIRTUAL) {
-                        allocateVirtualPages(newProcess, simulationTime);
+                for (int j = 0; j < sweep->numStrategies; j++) {
+                    if (sweep->strategies[j] == sweep->strategies[sweep->numStrategies]) {
+                        fprintf(stderr, "Memory strategy %s given twice\n", name);
+                        return -1;
                     }
-                    
-                    newProcess->isAllocated = true;
-                    currentProcess = newProcess;
                 }
-                
+                sweep->numStrategies++;
             }
-
-            // Fetch the next process to run if there isn't a current process
-            if (!currentProcess && !isQueueEmpty(readyQueue)) {
-                currentProcess = dequeue(readyQueue);
-                
+        } else if (strcmp(argv[i], "-x") == 0) {
+            options->switchCost = atoi(argv[i + 1]);
+            if (options->switchCost < 0) {
+                fprintf(stderr, "Invalid context switch cost\n");
+                return -1;
             }
-
-            if(!currentProcess->isAllocated) {
-
-                if (strategy == PAGED) {
-                    allocatePages(currentProcess, simulationTime);
-                } else if (strategy == VIRTUAL) {
-                    allocateVirtualPages(currentProcess, simulationTime);
-                }
-                currentProcess->isAllocated = true;
+        } else if (strcmp(argv[i], "-w") == 0) {
+            options->warmthPenalty = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            options->warmthDecay = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--swap-bandwidth") == 0) {
+            options->swapBandwidth = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--swap-latency") == 0) {
+            options->swapLatency = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--swap-depth") == 0) {
+            options->swapQueueDepth = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--reclaim-low") == 0) {
+            options->reclaimLowWatermark = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--reclaim-high") == 0) {
+            options->reclaimHighWatermark = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--tlb-entries") == 0) {
+            options->tlbEntries = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--tlb-ways") == 0) {
+            options->tlbWays = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--tlb-replacement") == 0) {
+            if (strcmp(argv[i + 1], "lru") == 0) {
+                options->tlbReplacement = TLB_LRU;
+            } else if (strcmp(argv[i + 1], "fifo") == 0) {
+                options->tlbReplacement = TLB_FIFO;
+            } else if (strcmp(argv[i + 1], "random") == 0) {
+                options->tlbReplacement = TLB_RANDOM;
+            } else {
+                fprintf(stderr, "Invalid TLB replacement policy\n");
+                return -1;
             }
-
-            // Execute the current process
-            if (currentProcess) {
-                int runTime = min(quantum, currentProcess->remainingTime);
-                if (!continuousRunning) {
-                    printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,", 
-                    simulationTime, 
-                    currentProcess->name, 
-                    currentProcess->remainingTime, 
-                    (int)calculateMemoryUsage());  
-                    // Call the function and cast the result to int
-                    printMemoryFrames(currentProcess);
-                    currentProcess->lastUsed = simulationTime;
-                } else {
-                    currentProcess->lastUsed = simulationTime;
-                }
-                
-                currentProcess->remainingTime -= runTime;
-                simulationTime += quantum;  
-
-                // Check for new arrivals and move them to the ready queue or set as current process
-                while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
-                    Process *newProcess = dequeue(allProcesses);
-
-                    if (currentProcess) {
-                
-                        enqueue(readyQueue, newProcess);
-                        continue;
-                    }
-
-                    if (!newProcess->isAllocated) {
-                        if (strategy == PAGED) {
-                            allocatePages(newProcess, simulationTime);
-                        } else if (strategy == VIRTUAL) {
-                            allocateVirtualPages(newProcess, simulationTime);
-                        }
-                        
-                        newProcess->isAllocated = true;
-                        currentProcess = newProcess;
-                    }
-                    
-                }
-
-                // Check if the process has finished
-                if (currentProcess->remainingTime <= 0) {
-                    deallocatePages(currentProcess, simulationTime);
-                    currentProcess->isAllocated = false;
-                    printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", simulationTime, currentProcess->name, readyQueue->count);
-                    numberOfProcesses++;
-                    currentProcess->completionTime = simulationTime;
-                    currentProcess->turnaroundTime = currentProcess->completionTime - currentProcess->arrivalTime;
-                    totalServiceTime += currentProcess->turnaroundTime;
-                    currentProcess->timeOverhead = currentProcess->turnaroundTime / (double)currentProcess->serviceTime;
-                    totTimeOverhead += currentProcess->timeOverhead;
-
-                    if (currentProcess->timeOverhead > maxTimeOverhead) {
-                        maxTimeOverhead = currentProcess->timeOverhead;
-                    }
-
-                    continuousRunning = false;
-                    // Deallocate memory when process finishes
-                    free(currentProcess);
-                    // Clear current process
-                    currentProcess = NULL;  
-                  // If process that was running still has remaining time
-                } else {
-                    if (isQueueEmpty(readyQueue)) {
-                        continuousRunning = true;
-                    } else {
-                        continuousRunning = false;
-                        // Re-queue if not finished
-                        enqueue(readyQueue, currentProcess);  
-                        currentProcess = NULL;
-                    }   
-                    
-                }
-               
+        } else if (strcmp(argv[i], "--tlb-asid") == 0) {
+            options->tlbTagged = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--tlb-miss-penalty") == 0) {
+            options->tlbMissPenalty = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--page-refs") == 0) {
+            options->pageReferences = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--demand-paging") == 0) {
+            options->demandPaging = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--ws-window") == 0) {
+            options->workingSetWindow = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--load-control") == 0) {
+            options->loadControl = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--swap-policy") == 0) {
+            if (strcmp(argv[i + 1], "none") == 0) {
+                options->processSwapPolicy = SWAP_NONE;
+            } else if (strcmp(argv[i + 1], "lru") == 0) {
+                options->processSwapPolicy = SWAP_LRU;
+            } else if (strcmp(argv[i + 1], "largest") == 0) {
+                options->processSwapPolicy = SWAP_LARGEST;
             } else {
-                simulationTime += quantum;  
+                fprintf(stderr, "Invalid swap policy\n");
+                return -1;
             }
-        }
-
-        // Task 5 implemenation to calculate the statistics
-        double averageTurnaroundTime = (double)totalServiceTime / numberOfProcesses;
-        double timeOverheadCalculation = (totTimeOverhead / numberOfProcesses) * 100.0;
-
-        int roundedAverageTurnaroundTime = (int)(averageTurnaroundTime + 0.999999);
-
-        double roundedTimeOverhead = (int)(timeOverheadCalculation + 0.5) / 100.0;
-
-        printf("Turnaround time %d\n", roundedAverageTurnaroundTime);
-        printf("Time overhead %.2f %.2f\n", maxTimeOverhead, roundedTimeOverhead);
-        printf("Makespan %d\n", simulationTime);
-
-      // Logic and implementation for task 1 and 2   
-    } else if (strategy == INFINITE || strategy == FIRST_FIT) {
-
-         int simulationTime = 0;
-        Process *currentProcess = NULL;
-        MemoryManager *memoryManager = NULL;
-        const int totalMemory = 2048;
-        int memoryUsed = 0;
-        
-
-        int totalServiceTime = 0;
-        int numberOfProcesses = 0;
-        double maxTimeOverhead = 0;
-        double totTimeOverhead = 0;
-
-        if (strategy == FIRST_FIT) {
-            memoryManager = createContiguousMemory(totalMemory);
-        }
-        
-
-        while (!isQueueEmpty(allProcesses) || !isQueueEmpty(readyQueue) || currentProcess != NULL) {
-
-            // Check for new arrivals and move them to the ready queue or set as current process
-            while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
-                
-                if (strategy == INFINITE) {
-                    Process *newProcess = dequeue(allProcesses);
-                    if (isQueueEmpty(readyQueue) && !currentProcess) {
-                        currentProcess = newProcess;
-                        printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                    } else if (isQueueEmpty(readyQueue) && currentProcess && newProcess->arrivalTime != currentProcess->arrivalTime) {
-                        enqueue(readyQueue, currentProcess);
-                        currentProcess = newProcess;
-                        printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                    } else {
-                        enqueue(readyQueue, newProcess);
-                    }
-                } else if (strategy == FIRST_FIT) {
-                    Process *temp = dequeue(allProcesses);
-
-                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
-
-                    // If the allocation from allProcesses is not successful, just enqueue to the ready queue and continue
-                    if (address == -1) {
-                        enqueue(readyQueue, temp);
-                        // Skip scheduling this process, keep it for later attempt
-                        continue; 
-                    } 
-
-
-                    temp->memoryAddress = address;
-                    memoryUsed += temp->memoryRequirement;
-
-
-                    // Run process again if ready queue is empty and there is no process that is running
-                    if (isQueueEmpty(readyQueue) && !currentProcess) {
-                        currentProcess = temp;
-                        printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                        simulationTime, 
-                        currentProcess->name, 
-                        currentProcess->remainingTime,
-                        (memoryUsed * 100 + totalMemory - 1) / totalMemory,
-                        currentProcess->memoryAddress);
-                    
-                    // Ensure that there is only one process that is running
-                    } else if (isQueueEmpty(readyQueue) && currentProcess && temp->arrivalTime != currentProcess->arrivalTime) {
-                        enqueue(readyQueue, currentProcess);
-                        currentProcess = temp;
-                        printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                        simulationTime, 
-                        currentProcess->name, 
-                        currentProcess->remainingTime,
-                        (memoryUsed * 100 + totalMemory - 1) / totalMemory,
-                        currentProcess->memoryAddress);
-                    } else {
-                        enqueue(readyQueue, temp);
-                    }
-
-                }
+        } else if (strcmp(argv[i], "--cow-writes") == 0) {
+            options->cowWritePercent = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--fault-penalty") == 0) {
+            options->faultPenalty = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--mem-health") == 0) {
+            options->memoryHealth = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--percentiles") == 0) {
+            options->latencyPercentiles = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            options->tracePath = argv[i + 1];
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            options->checkpointPath = argv[i + 1];
+        } else if (strcmp(argv[i], "--checkpoint-at") == 0) {
+            options->checkpointTime = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--checkpoint-events") == 0) {
+            options->checkpointEvents = atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "--checkpoint-stop") == 0) {
+            options->checkpointStop = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--restore") == 0) {
+            options->restorePath = argv[i + 1];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            options->profile = atoi(argv[i + 1]) != 0;
+#ifndef PROFILE
+            if (options->profile) {
+                fprintf(stderr, "Built without profiling, rebuild with make PROFILE=1\n");
+                return -1;
             }
-
-        
-            // Update the information of the process that is running
-            if (currentProcess) {
-                int runTime = min(quantum, currentProcess->remainingTime);
-                currentProcess->remainingTime -= runTime;
-                simulationTime += quantum;
-
-                if (currentProcess->remainingTime > 0) {
-                    if (!isQueueEmpty(readyQueue)) {
-
-                        
-                        // Check for new arrivals and move them to the ready queue or set as current process
-                        while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
-                            
-                            if (strategy == INFINITE) {
-                                Process *newProcess = dequeue(allProcesses);
-                                if (isQueueEmpty(readyQueue) && !currentProcess) {
-                                    currentProcess = newProcess;
-                                    printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                                } else if (isQueueEmpty(readyQueue) && currentProcess && newProcess->arrivalTime != currentProcess->arrivalTime) {
-                                    enqueue(readyQueue, currentProcess);
-                                    currentProcess = newProcess;
-                                    printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                                } else {
-                                    enqueue(readyQueue, newProcess);
-                                }
-                            } else if (strategy == FIRST_FIT) {
-
-                                Process *temp = dequeue(allProcesses);
-
-                                if (isQueueEmpty(readyQueue) && !currentProcess) {
-      
-                                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
-                                    if (address == -1) {
-                                        printf("%d, WAITING, process-name=%s, reason=Memory Allocation Failed\n", simulationTime, temp->name);
-                                        // Skip scheduling this process, keep it for later attempt
-                                        continue; 
-                                    } 
-
-                                    temp->memoryAddress = address;
-                                    memoryUsed += temp->memoryRequirement;
-
-                                    currentProcess = temp;
-                                    printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                                    simulationTime, 
-                                    currentProcess->name, 
-                                    currentProcess->remainingTime,
-                                    (memoryUsed * 100 + totalMemory - 1) / totalMemory,
-                                    currentProcess->memoryAddress);
-                                  // Ensure only one process is running
-                                } else if (isQueueEmpty(readyQueue) && currentProcess && temp->arrivalTime != currentProcess->arrivalTime) {
-                                    
-                                    int address = allocateMemory(memoryManager, temp->memoryRequirement);
-                                    if (address == -1) {
-                                        enqueue(readyQueue, temp);
-                                        continue; 
-                                    } 
-
-                                    temp->memoryAddress = address;
-                                    memoryUsed += temp->memoryRequirement;
-
-                                    enqueue(readyQueue, currentProcess);
-                                    currentProcess = temp;
-                                    printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                                    simulationTime, 
-                                    currentProcess->name, 
-                                    currentProcess->remainingTime,
-                                    (memoryUsed * 100) / totalMemory,
-                                    currentProcess->memoryAddress);
-                                } else {
-                                    
-                                    enqueue(readyQueue, temp);
-                        
-                                
-                                }
-
-                            }
-                        }
-
-                        enqueue(readyQueue, currentProcess);
-                        // Clear currentProcess to pick the next available process
-                        currentProcess = NULL; 
-                    }
-                } else {
-
-                    // Update for task 5 statistics 
-                    numberOfProcesses++;
-                    currentProcess->completionTime = simulationTime;
-                    currentProcess->turnaroundTime = currentProcess->completionTime - currentProcess->arrivalTime;
-                    totalServiceTime += currentProcess->turnaroundTime;
-                    currentProcess->timeOverhead = currentProcess->turnaroundTime / currentProcess->serviceTime;
-                    totTimeOverhead += currentProcess->timeOverhead;
-
-                    if (currentProcess->timeOverhead > maxTimeOverhead) {
-                        maxTimeOverhead = currentProcess->timeOverhead;
-                    }
-
-                    if (memoryManager) {
-                        deallocateMemory(memoryManager, currentProcess->memoryAddress, currentProcess->memoryRequirement);
-                        memoryUsed -= currentProcess->memoryRequirement;
-                    }
-                     // Check for new arrivals and move them to the ready queue or set as current process
-                    while (!isQueueEmpty(allProcesses) && peek(allProcesses)->arrivalTime <= simulationTime) {
-                        
-                        if (strategy == INFINITE) {
-                            Process *newProcess = dequeue(allProcesses);
-                            if (isQueueEmpty(readyQueue) && !currentProcess) {
-                                currentProcess = newProcess;
-                                printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                            } else if (isQueueEmpty(readyQueue) && currentProcess && newProcess->arrivalTime != currentProcess->arrivalTime) {
-                                enqueue(readyQueue, currentProcess);
-                                currentProcess = newProcess;
-                                printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-                            } else {
-                                enqueue(readyQueue, newProcess);
-                            }
-                        } else if (strategy == FIRST_FIT) {
-
-                            Process *temp = dequeue(allProcesses);
-
-
-                            if (isQueueEmpty(readyQueue) && !currentProcess) {
-
-                                
-                                int address = allocateMemory(memoryManager, temp->memoryRequirement);
-                                if (address == -1) {
-                                    printf("%d, WAITING, process-name=%s, reason=Memory Allocation Failed\n", simulationTime, temp->name);
-                                    // Skip scheduling this process, keep it for later attempt
-                                    continue; 
-                                } 
-
-                            
-
-                                temp->memoryAddress = address;
-                                memoryUsed += temp->memoryRequirement;
-
-
-                                currentProcess = temp;
-                                printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                                simulationTime, 
-                                currentProcess->name, 
-                                currentProcess->remainingTime,
-                                (memoryUsed * 100 + totalMemory - 1) / totalMemory,
-                                currentProcess->memoryAddress);
-                            
-                            } else if (isQueueEmpty(readyQueue) && currentProcess && temp->arrivalTime != currentProcess->arrivalTime) {
-                                
-                                int address = allocateMemory(memoryManager, temp->memoryRequirement);
-                                // If fail to allocate memory, enqueue to ready queue
-                                if (address == -1) {
-                                    enqueue(readyQueue, temp);
-                                    continue; 
-                                } 
-
-                                temp->memoryAddress = address;
-                                memoryUsed += temp->memoryRequirement;
-
-                                enqueue(readyQueue, currentProcess);
-                                currentProcess = temp;
-                                printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", 
-                                simulationTime, 
-                                currentProcess->name, 
-                                currentProcess->remainingTime,
-                                (memoryUsed * 100) / totalMemory,
-                                currentProcess->memoryAddress);
-                            } else {   
-                                enqueue(readyQueue, temp);  
-                            }
-
-                        }
-                    }
-                    
-                    printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", simulationTime, currentProcess->name, readyQueue->count);
-                    
-                    // Assuming memory management is required
-                    free(currentProcess); 
-                    currentProcess = NULL;
-                }
-                
-            } 
-            
-            else {
-                simulationTime += quantum;
+#endif
+        } else if (strcmp(argv[i], "--numa-nodes") == 0) {
+            options->numaNodes = atoi(argv[i + 1]);
+            if (options->numaNodes < 1 || options->numaNodes > MAX_NUMA_NODES) {
+                fprintf(stderr, "Invalid number of NUMA nodes\n");
+                return -1;
             }
-
-            // Dequeue to ready queue when a process finishes running
-            if (!currentProcess && !isQueueEmpty(readyQueue) && strategy == INFINITE) {
-                currentProcess = dequeue(readyQueue);
-                printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, currentProcess->name, currentProcess->remainingTime);
-
-
-            } else if(!currentProcess && !isQueueEmpty(readyQueue) && strategy == FIRST_FIT) {
-
-                // Iterate until a process with allocated is found    
-                while(!isQueueEmpty(readyQueue)) {
-                    Process *temp = dequeue(readyQueue);
-                    if(temp->memoryAddress == -1) {
-                        int address = allocateMemory(memoryManager, temp->memoryRequirement);
-                        if (address == -1) {
-                            enqueue(readyQueue, temp);
-                            // Skip scheduling this process, keep it for later attempt
-                            continue; 
-                        } else {
-                            temp->memoryAddress = address;
-                            memoryUsed += temp->memoryRequirement;
-                            currentProcess = temp;
-                            break;
-                        }
-
-                        
-                    } else {
-                        currentProcess = temp;
-                        break;
-                    }
-                }
-
-                printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n",
-                    simulationTime,
-                    currentProcess->name,
-                    currentProcess->remainingTime,
-                    (memoryUsed * 100 + totalMemory - 1) / totalMemory,
-                    currentProcess->memoryAddress);
+        } else if (strcmp(argv[i], "--numa-policy") == 0) {
+            if (strcmp(argv[i + 1], "local") == 0) {
+                options->numaPolicy = NUMA_LOCAL;
+            } else if (strcmp(argv[i + 1], "interleave") == 0) {
+                options->numaPolicy = NUMA_INTERLEAVE;
+            } else if (strcmp(argv[i + 1], "migrate") == 0) {
+                options->numaPolicy = NUMA_MIGRATE;
+            } else {
+                fprintf(stderr, "Invalid NUMA policy\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--numa-remote-penalty") == 0) {
+            options->numaRemotePenalty = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--numa-migrate-cost") == 0) {
+            options->numaMigrateCost = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--huge-pages") == 0) {
+            options->hugePageFrames = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-j") == 0) {
+            sweep->threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            if (strcmp(argv[i + 1], "rr") == 0) {
+                options->policy = ROUND_ROBIN;
+            } else if (strcmp(argv[i + 1], "cfs") == 0) {
+                options->policy = FAIR;
+            } else if (strcmp(argv[i + 1], "mlfq") == 0) {
+                options->policy = FEEDBACK;
+            } else {
+                fprintf(stderr, "Invalid scheduling policy\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-l") == 0) {
+            options->feedbackLevels = atoi(argv[i + 1]);
+            if (options->feedbackLevels < 1 || options->feedbackLevels > FEEDBACK_MAX_LEVELS) {
+                fprintf(stderr, "Invalid number of feedback levels\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-b") == 0) {
+            options->boostInterval = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-c") == 0) {
+            options->cores = atoi(argv[i + 1]);
+            if (options->cores < 1) {
+                fprintf(stderr, "Invalid number of cores\n");
+                return -1;
             }
         }
-        // Statistics for task 5
-        double averageTurnaroundTime = (double)totalServiceTime / numberOfProcesses;
-        double timeOverheadCalculation = (totTimeOverhead / numberOfProcesses) * 100.0;
-
-        int roundedAverageTurnaroundTime = (int)(averageTurnaroundTime + 0.999999);
-
-        double roundedTimeOverhead = (int)(timeOverheadCalculation + 0.5) / 100.0;
-
-        printf("Turnaround time %d\n", roundedAverageTurnaroundTime);
-        printf("Time overhead %.2f %.2f\n", maxTimeOverhead, roundedTimeOverhead);
-        printf("Makespan %d\n", simulationTime);
     }
-
-
+    // A checkpoint is taken either at a time or after a number of events
+    if (options->checkpointPath && (options->checkpointTime >= 0) == (options->checkpointEvents > 0)) {
+        fprintf(stderr, "A checkpoint needs one of --checkpoint-at and --checkpoint-events\n");
+        return -1;
     }
+    // A sweep takes its quanta from -Q and a restore from the checkpoint, so -q is optional there
+    return (*filename && (*quantum > 0 || sweep->numQuanta > 0 || options->restorePath)) ? 0 : -1;
+}
 
-// Finding the minimum
-int min(int x, int y) {
-    return x < y ? x : y;
+int parseMemoryStrategy(const char *name, MemoryStrategy *strategy) {
+    if (strcmp(name, "infinite") == 0) {
+        *strategy = INFINITE;
+    } else if (strcmp(name, "first-fit") == 0) {
+        *strategy = FIRST_FIT;
+    } else if (strcmp(name, "paged") == 0) {
+        *strategy = PAGED;
+    } else if (strcmp(name, "virtual") == 0) {
+        *strategy = VIRTUAL;
+    } else {
+        return -1;
+    }
+    return 0;
 }
 
-// Print running of a process
-void printProcessStats(Process *process, int simulationTime, Queue *queue) {
-    printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", simulationTime, process->name, process->remainingTime);
+// A workload written by the convert tool, every process created at once for the runs
+// that need the whole input queued
+Queue* readBinaryProcesses(char *filename) {
+    Workload workload;
+    if (openWorkload(&workload, filename) != 0) {
+        fprintf(stderr, "Invalid binary workload %s\n", filename);
+        return NULL;
+    }
+    Queue *queue = createQueue();
+    if (queue && queueWorkloadProcesses(queue, &workload) != 0) {
+        fprintf(stderr, "Invalid process %d in %s\n", queue->count, filename);
+        freeQueue(queue);
+        queue = NULL;
+    }
+    closeWorkload(&workload);
+    return queue;
 }
 
+Queue* readProcessesFromFile(char *filename) {
+    if (isWorkloadFile(filename)) {
+        return readBinaryProcesses(filename);
+    }
+    FILE *file = fopen(filename, "r");
+    if (!file) return NULL;
+
+    Queue *queue = createQueue();
+    Process *temp;
+    char line[4096];
 
+    // One process per line, optionally followed by its page reference pattern, a shared
+    // segment as shared:<id>:<size in KB> and a memory group as group:<id>[:<limit in KB>],
+    // in any order
+    while (fgets(line, sizeof(line), file)) {
+        int consumed = 0;
+        temp = (Process *)malloc(sizeof(Process));
+        int fields = sscanf(line, "%d %8s %d %d%n", &temp->arrivalTime, temp->name, &temp->serviceTime, &temp->memoryRequirement, &consumed);
+        if (fields >= 4) {
+            initializeInputProcess(temp);
+            if (parseProcessColumns(temp, line + consumed) != 0) {
+                fprintf(stderr, "Invalid optional column for %s\n", temp->name);
+                freeProcess(temp);
+                freeQueue(queue);
+                fclose(file);
+                return NULL;
+            }
+            enqueue(queue, temp);
+        } else {
+            free(temp);
+        }
+    }
+    fclose(file);
+    return queue;
+}
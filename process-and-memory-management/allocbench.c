@@ -0,0 +1,366 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Process.h"
+#include "ContiguousMemory.h"
+#include "PagedMemory.h"
+
+// Allocator microbenchmark. Drives the contiguous and paged allocators directly, without
+// the scheduler, and times every operation. The frame table is created without an output
+// so eviction events cost nothing to print
+
+typedef enum {
+    PATTERN_FIFO,    // Blocks are freed in the order they were allocated
+    PATTERN_RANDOM,  // A random live block is freed, so lifetimes are random
+    PATTERN_FRAGMENT // Fill with small blocks, free every other one, then ask for blocks no hole fits
+} Pattern;
+
+typedef enum {
+    OP_ALLOCATE,
+    OP_FAILED,
+    OP_FREE,
+    OP_KINDS
+} Operation;
+
+static const char *patternNames[] = {"fifo", "random", "fragment"};
+static const char *operationNames[] = {"allocate", "failed", "free"};
+
+typedef struct {
+    int size; // KB requested
+    int address; // Start of the block under contiguous allocation
+    Process process; // Owner of the frames under paged allocation, never moves
+} Block;
+
+typedef struct {
+    long operations; // Operations per allocator and pattern
+    unsigned long long seed; // Seed of the size and victim choices
+    int liveLimit; // Most blocks live at once
+    int minSize; // Smallest block in KB
+    int maxSize; // Largest block in KB
+    int memory; // Size of the contiguous memory in KB
+} BenchOptions;
+
+// One allocator behind the pattern driver
+typedef struct {
+    const char *name;
+    void *(*create)(BenchOptions *options);
+    int (*allocate)(void *state, Block *block, int clock); // 0 on success
+    void (*release)(void *state, Block *block, int clock);
+    int (*size)(void *state); // Holes or frames in use, the structure the next operation works on
+    void (*destroy)(void *state);
+} Allocator;
+
+int parseBenchArguments(int argc, char *argv[], BenchOptions *options);
+
+static void *createContiguous(BenchOptions *options) {
+    return createContiguousMemory(options->memory);
+}
+
+static int allocateContiguous(void *state, Block *block, int clock) {
+    (void)clock;
+    block->address = allocateMemory((MemoryManager *)state, block->size);
+    return block->address == -1 ? -1 : 0;
+}
+
+static void releaseContiguous(void *state, Block *block, int clock) {
+    (void)clock;
+    deallocateMemory((MemoryManager *)state, block->address, block->size);
+}
+
+static int contiguousHoles(void *state) {
+    return ((MemoryManager *)state)->holeCount;
+}
+
+static void destroyContiguous(void *state) {
+    freeContiguousMemory((MemoryManager *)state);
+}
+
+static void *createFrames(BenchOptions *options) {
+    (void)options;
+    FrameTable *table = (FrameTable *)malloc(sizeof(FrameTable));
+    if (table) {
+        initializeFrames(table, NULL);
+    }
+    return table;
+}
+
+static void prepareProcess(Block *block, int clock) {
+    memset(&block->process, 0, sizeof(Process));
+    snprintf(block->process.name, sizeof(block->process.name), "B%u", (unsigned int)clock % 10000000u);
+    block->process.memoryRequirement = block->size;
+    block->process.memoryAddress = -1;
+    block->process.lastCpu = -1;
+    block->process.lastUsed = clock;
+    block->process.sharedSegment = -1;
+    block->process.memoryGroup = -1;
+}
+
+// A failed allocation keeps its page table, give it back like the scheduler would
+static int finishAllocation(Block *block, int result) {
+    if (result != 0) {
+        free(block->process.frameAllocations);
+        block->process.frameAllocations = NULL;
+        return -1;
+    }
+    block->process.isAllocated = true;
+    return 0;
+}
+
+static int allocatePaged(void *state, Block *block, int clock) {
+    return finishAllocation(block, allocatePages((FrameTable *)state, &block->process, clock));
+}
+
+static int allocateVirtual(void *state, Block *block, int clock) {
+    return finishAllocation(block, allocateVirtualPages((FrameTable *)state, &block->process, clock));
+}
+
+static void releaseFrames(void *state, Block *block, int clock) {
+    deallocatePages((FrameTable *)state, &block->process, clock);
+}
+
+static int framesUsed(void *state) {
+    return ((FrameTable *)state)->framesUsed;
+}
+
+static void destroyFrames(void *state) {
+    freeFrameTable((FrameTable *)state);
+    free(state);
+}
+
+static const Allocator allocators[] = {
+    {"first-fit", createContiguous, allocateContiguous, releaseContiguous, contiguousHoles, destroyContiguous},
+    {"paged", createFrames, allocatePaged, releaseFrames, framesUsed, destroyFrames},
+    {"virtual", createFrames, allocateVirtual, releaseFrames, framesUsed, destroyFrames},
+};
+
+// splitmix64, the same sequence on every platform
+static unsigned long long nextRandom(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static long nanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+// Timings of one kind of operation
+typedef struct {
+    long *samples;
+    long count;
+} Samples;
+
+static void record(Samples *samples, long elapsed) {
+    samples->samples[samples->count++] = elapsed;
+}
+
+static int compareLongs(const void *a, const void *b) {
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static long percentile(Samples *samples, double fraction) {
+    long index = (long)(fraction * (samples->count - 1));
+    return samples->samples[index];
+}
+
+// State of one run of a pattern. live holds the indices of the live blocks, oldest first
+// under fifo, and free the indices of the unused ones
+typedef struct {
+    const Allocator *allocator;
+    void *state;
+    Block *blocks;
+    int *live;
+    int liveCount;
+    int *free;
+    int freeCount;
+    Samples samples[OP_KINDS];
+    long operations;
+    long sizeTotal; // Sum of the structure size seen before each operation
+    int peakSize; // Largest structure size seen
+    int clock; // Operation counter, the simulated time handed to the allocator
+} Run;
+
+static void noteSize(Run *run) {
+    int size = run->allocator->size(run->state);
+    run->sizeTotal += size;
+    if (size > run->peakSize) {
+        run->peakSize = size;
+    }
+}
+
+// Allocate a block of size, return its index or -1 if the allocator found no room
+static int allocateBlock(Run *run, int size) {
+    if (run->freeCount == 0) {
+        return -1;
+    }
+    int index = run->free[run->freeCount - 1];
+    Block *block = &run->blocks[index];
+    block->size = size;
+    prepareProcess(block, run->clock);
+    noteSize(run);
+
+    long start = nanoseconds();
+    int result = run->allocator->allocate(run->state, block, run->clock++);
+    long elapsed = nanoseconds() - start;
+    record(&run->samples[result == 0 ? OP_ALLOCATE : OP_FAILED], elapsed);
+    run->operations++;
+    if (result != 0) {
+        return -1;
+    }
+    run->freeCount--;
+    run->live[run->liveCount++] = index;
+    return index;
+}
+
+// Free the live block at position in the live list, keeping the order of the others
+static void freeBlock(Run *run, int position) {
+    int index = run->live[position];
+    noteSize(run);
+
+    long start = nanoseconds();
+    run->allocator->release(run->state, &run->blocks[index], run->clock++);
+    record(&run->samples[OP_FREE], nanoseconds() - start);
+    run->operations++;
+    memmove(&run->live[position], &run->live[position + 1], (run->liveCount - position - 1) * sizeof(int));
+    run->liveCount--;
+    run->free[run->freeCount++] = index;
+}
+
+static int randomSize(BenchOptions *options, unsigned long long *random) {
+    return options->minSize + (int)(nextRandom(random) % (options->maxSize - options->minSize + 1));
+}
+
+static void runPattern(Run *run, Pattern pattern, BenchOptions *options) {
+    unsigned long long random = options->seed;
+    while (run->operations < options->operations) {
+        if (pattern == PATTERN_FRAGMENT) {
+            // Checkerboard of minimum sized blocks, then requests larger than any hole
+            long before = run->operations;
+            while (run->operations < options->operations && allocateBlock(run, options->minSize) != -1) {
+            }
+            for (int i = run->liveCount - 2; i >= 0; i -= 2) {
+                freeBlock(run, i);
+            }
+            for (int i = 0; i < run->liveCount && run->operations < options->operations; i++) {
+                int index = allocateBlock(run, options->maxSize);
+                if (index != -1) {
+                    freeBlock(run, run->liveCount - 1);
+                }
+            }
+            while (run->liveCount > 0) {
+                freeBlock(run, run->liveCount - 1);
+            }
+            if (run->operations == before) {
+                break;
+            }
+        } else if (run->liveCount < options->liveLimit && allocateBlock(run, randomSize(options, &random)) != -1) {
+            continue;
+        } else if (run->liveCount > 0) {
+            freeBlock(run, pattern == PATTERN_FIFO ? 0 : (int)(nextRandom(&random) % run->liveCount));
+        } else {
+            // Not even one block fits
+            break;
+        }
+    }
+    while (run->liveCount > 0) {
+        freeBlock(run, run->liveCount - 1);
+    }
+}
+
+static int benchmark(const Allocator *allocator, Pattern pattern, BenchOptions *options) {
+    // Every operation is recorded, the teardown frees at most liveLimit more blocks
+    long capacity = options->operations + options->liveLimit + 1;
+    Run run = {allocator, allocator->create(options), NULL, NULL, 0, NULL, 0, {{0}}, 0, 0, 0, 0};
+    run.blocks = (Block *)calloc(options->liveLimit, sizeof(Block));
+    run.live = (int *)malloc(options->liveLimit * sizeof(int));
+    run.free = (int *)malloc(options->liveLimit * sizeof(int));
+    int failed = !run.state || !run.blocks || !run.live || !run.free;
+    for (int i = 0; i < OP_KINDS && !failed; i++) {
+        run.samples[i].samples = (long *)malloc(capacity * sizeof(long));
+        failed = !run.samples[i].samples;
+    }
+
+    if (!failed) {
+        for (int i = 0; i < options->liveLimit; i++) {
+            run.free[i] = options->liveLimit - 1 - i;
+        }
+        run.freeCount = options->liveLimit;
+        runPattern(&run, pattern, options);
+        for (int i = 0; i < OP_KINDS; i++) {
+            Samples *samples = &run.samples[i];
+            if (samples->count == 0) {
+                continue;
+            }
+            qsort(samples->samples, samples->count, sizeof(long), compareLongs);
+            printf("%s,%s,%s,%ld,%ld,%ld,%ld,%ld,%ld,%.1f,%d\n", allocator->name, patternNames[pattern],
+                   operationNames[i], samples->count, percentile(samples, 0.5), percentile(samples, 0.9),
+                   percentile(samples, 0.99), percentile(samples, 0.999), samples->samples[samples->count - 1],
+                   run.operations ? (double)run.sizeTotal / run.operations : 0.0, run.peakSize);
+        }
+        fflush(stdout);
+    } else {
+        fprintf(stderr, "Out of memory benchmarking %s\n", allocator->name);
+    }
+
+    for (int i = 0; i < OP_KINDS; i++) {
+        free(run.samples[i].samples);
+    }
+    if (run.state) {
+        allocator->destroy(run.state);
+    }
+    free(run.blocks);
+    free(run.live);
+    free(run.free);
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options = {100000, 1, 256, 4, 64, 2048};
+    if (parseBenchArguments(argc, argv, &options) != 0) {
+        fprintf(stderr, "Usage: %s [-n operations] [-s seed] [--live blocks] [--min-size KB] [--max-size KB] "
+                        "[--memory KB]\n", argv[0]);
+        return 1;
+    }
+
+    // size is the hole count for first-fit and the frames in use for the paged allocators
+    printf("allocator,pattern,operation,count,p50-ns,p90-ns,p99-ns,p99.9-ns,max-ns,mean-size,peak-size\n");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        for (int pattern = PATTERN_FIFO; pattern <= PATTERN_FRAGMENT; pattern++) {
+            failed |= benchmark(&allocators[i], (Pattern)pattern, &options) != 0;
+        }
+    }
+    return failed;
+}
+
+int parseBenchArguments(int argc, char *argv[], BenchOptions *options) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return -1;
+        }
+        if (strcmp(argv[i], "-n") == 0) {
+            options->operations = atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            options->seed = strtoull(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--live") == 0) {
+            options->liveLimit = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--min-size") == 0) {
+            options->minSize = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--max-size") == 0) {
+            options->maxSize = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            options->memory = atoi(argv[i + 1]);
+        } else {
+            return -1;
+        }
+    }
+    return options->operations < 1 || options->liveLimit < 1 || options->minSize < 1 ||
+           options->maxSize < options->minSize || options->memory < options->maxSize ? -1 : 0;
+}
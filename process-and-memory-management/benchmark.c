@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+// End-to-end benchmark. For every size it generates a workload with ./generate and runs
+// ./allocate on it once per memory strategy, timing the run and counting the events
+// it prints. Peak RSS comes from the rusage of the allocate process alone. Runs use
+// the fair policy unless -a says otherwise: generated workloads leave the CPU idle and
+// make processes wait for memory, which the round robin reference loop does not handle
+// under infinite and first-fit memory; -m picks the strategies to run. A run still
+// going after the timeout is killed and its row marked failed
+
+#define MAX_ARGUMENTS 64
+
+static const char *allStrategies[] = {"infinite", "first-fit", "paged", "virtual"};
+
+typedef struct {
+    const char *quantum; // Quantum passed to allocate
+    const char *seed; // Seed passed to the generator
+    char *generatorArgs; // Extra generator arguments, split on spaces
+    char *allocateArgs; // Extra allocate arguments, split on spaces
+    int timeout; // Seconds an allocate run may take, 0 for no limit
+    const char *strategies[MAX_ARGUMENTS]; // Memory strategies to time at each size
+    int strategyCount;
+} BenchmarkOptions;
+
+// Append the words of extra to argv, stopping before MAX_ARGUMENTS
+static int appendWords(char **argv, int argc, char *extra) {
+    for (char *word = extra ? strtok(extra, " ") : NULL; word && argc < MAX_ARGUMENTS - 1; word = strtok(NULL, " ")) {
+        argv[argc++] = word;
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+// Run argv with stdout sent to output, or read back through a pipe when output is -1 so
+// the events can be counted. A timeout in seconds kills the program with SIGALRM, which
+// carries over the exec. Return the exit status, -1 if the program could not run or was killed
+static int runProgram(char **argv, int output, int timeout, long *lines, struct rusage *usage) {
+    int pipefd[2] = {-1, -1};
+    if (output == -1 && pipe(pipefd) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        return -1;
+    }
+    if (pid == 0) {
+        dup2(output == -1 ? pipefd[1] : output, STDOUT_FILENO);
+        if (pipefd[0] != -1) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+        }
+        alarm(timeout);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+
+    if (pipefd[0] != -1) {
+        // Every event line starts with its time, the summary lines do not
+        close(pipefd[1]);
+        FILE *events = fdopen(pipefd[0], "r");
+        char line[4096];
+        int atLineStart = 1;
+        while (events && fgets(line, sizeof(line), events)) {
+            if (atLineStart && line[0] >= '0' && line[0] <= '9') {
+                (*lines)++;
+            }
+            atLineStart = line[strlen(line) - 1] == '\n';
+        }
+        if (events) {
+            fclose(events);
+        } else {
+            close(pipefd[0]);
+        }
+    }
+    int status;
+    if (wait4(pid, &status, 0, usage) == -1) {
+        return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static double seconds(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Generate the workload for one size and time each strategy on it
+static int benchmarkSize(const char *size, BenchmarkOptions *options) {
+    const char *directory = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/benchXXXXXX", directory);
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        perror("mkstemp");
+        return -1;
+    }
+
+    char *generator[MAX_ARGUMENTS] = {"./generate", "-n", (char *)size, "-s", (char *)options->seed};
+    char *generatorArgs = options->generatorArgs ? strdup(options->generatorArgs) : NULL;
+    appendWords(generator, 5, generatorArgs);
+    long ignored = 0;
+    struct rusage usage;
+    int status = runProgram(generator, fd, 0, &ignored, &usage);
+    close(fd);
+    free(generatorArgs);
+    if (status != 0) {
+        fprintf(stderr, "Failed to generate %s processes\n", size);
+        unlink(path);
+        return -1;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < options->strategyCount; i++) {
+        const char *strategy = options->strategies[i];
+        char *allocate[MAX_ARGUMENTS] = {"./allocate", "-f", path, "-q", (char *)options->quantum, "-m", (char *)strategy};
+        char *allocateArgs = options->allocateArgs ? strdup(options->allocateArgs) : NULL;
+        appendWords(allocate, 7, allocateArgs);
+
+        long events = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        status = runProgram(allocate, -1, options->timeout, &events, &usage);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        free(allocateArgs);
+
+        double wall = seconds(&start, &end);
+        if (status != 0 && options->timeout > 0 && wall >= options->timeout) {
+            fprintf(stderr, "%s on %s processes timed out after %ds\n", strategy, size, options->timeout);
+        }
+        printf("%s,%s,%ld,%.3f,%.0f,%ld%s\n", size, strategy, events, wall, wall > 0 ? events / wall : 0.0,
+               usage.ru_maxrss, status == 0 ? "" : ",failed");
+        fflush(stdout);
+        failed |= status != 0;
+    }
+    unlink(path);
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    char defaultArgs[] = "-s cfs";
+    BenchmarkOptions options = {"3", "1", NULL, defaultArgs, 600, {NULL}, 0};
+    char *strategyList = NULL;
+    int first = 1;
+    for (; first + 1 < argc && argv[first][0] == '-'; first += 2) {
+        if (strcmp(argv[first], "-q") == 0) {
+            options.quantum = argv[first + 1];
+        } else if (strcmp(argv[first], "-s") == 0) {
+            options.seed = argv[first + 1];
+        } else if (strcmp(argv[first], "-g") == 0) {
+            options.generatorArgs = argv[first + 1];
+        } else if (strcmp(argv[first], "-a") == 0) {
+            options.allocateArgs = argv[first + 1];
+        } else if (strcmp(argv[first], "-t") == 0) {
+            options.timeout = atoi(argv[first + 1]);
+        } else if (strcmp(argv[first], "-m") == 0) {
+            strategyList = argv[first + 1];
+        } else {
+            break;
+        }
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [-q quantum] [-s seed] [-g generator-args] [-a allocate-args] [-t timeout seconds] [-m strategy,...] size...\n", argv[0]);
+        return 1;
+    }
+    for (char *strategy = strategyList ? strtok(strategyList, ",") : NULL; strategy && options.strategyCount < MAX_ARGUMENTS;
+         strategy = strtok(NULL, ",")) {
+        options.strategies[options.strategyCount++] = strategy;
+    }
+    if (!strategyList) {
+        for (size_t i = 0; i < sizeof(allStrategies) / sizeof(allStrategies[0]); i++) {
+            options.strategies[options.strategyCount++] = allStrategies[i];
+        }
+    }
+
+    printf("processes,strategy,events,wall-seconds,events-per-second,peak-rss-kb\n");
+    int failed = 0;
+    for (int i = first; i < argc; i++) {
+        failed |= benchmarkSize(argv[i], &options) != 0;
+    }
+    return failed;
+}
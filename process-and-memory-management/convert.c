@@ -0,0 +1,151 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Workload.h"
+
+// Converts a workload from the allocate text format to the binary format of
+// Workload.h, which allocate -f detects and maps instead of parsing. Lines are read the
+// way allocate reads them, and optional columns are kept as text. Each column goes to a
+// temporary file as it is read, so memory stays constant however large the input
+
+// Columns in the order they follow the header
+enum {
+    ARRIVAL_COLUMN,
+    SERVICE_COLUMN,
+    MEMORY_COLUMN,
+    NAME_COLUMN,
+    EXTRA_COLUMN,
+    STRING_TABLE,
+    OUTPUT_PARTS
+};
+
+// Append string to the string table and return its offset
+static uint32_t addString(FILE *strings, uint64_t *stringsSize, const char *string) {
+    size_t length = strlen(string) + 1;
+    if (*stringsSize + length >= WORKLOAD_NO_STRING) {
+        return WORKLOAD_NO_STRING;
+    }
+    uint32_t offset = (uint32_t)*stringsSize;
+    fwrite(string, length, 1, strings);
+    *stringsSize += length;
+    return offset;
+}
+
+// Copy a temporary part to the end of output
+static int copyPart(FILE *part, FILE *output) {
+    static char buffer[1 << 16];
+    if (ferror(part) || fflush(part) != 0) {
+        return -1;
+    }
+    rewind(part);
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), part)) > 0) {
+        if (fwrite(buffer, 1, read, output) != read) {
+            return -1;
+        }
+    }
+    return ferror(part) ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <text workload> <binary workload>\n", argv[0]);
+        return 1;
+    }
+    FILE *input = fopen(argv[1], "r");
+    if (!input) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    FILE *parts[OUTPUT_PARTS];
+    for (int i = 0; i < OUTPUT_PARTS; i++) {
+        if (!(parts[i] = tmpfile())) {
+            fprintf(stderr, "Failed to create a temporary file\n");
+            return 1;
+        }
+    }
+
+    uint64_t count = 0;
+    uint64_t stringsSize = 0;
+    int hasExtraColumns = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), input)) {
+        int arrival, service, memory;
+        char name[9];
+        int consumed = 0;
+        if (sscanf(line, "%d %8s %d %d%n", &arrival, name, &service, &memory, &consumed) < 4) {
+            continue;
+        }
+        // Optional columns without the surrounding blanks, allocate parses them on load
+        char *extra = line + consumed;
+        extra += strspn(extra, " \t\r\n");
+        size_t length = strlen(extra);
+        while (length > 0 && strchr(" \t\r\n", extra[length - 1])) {
+            extra[--length] = '\0';
+        }
+
+        uint32_t nameOffset = addString(parts[STRING_TABLE], &stringsSize, name);
+        uint32_t extraOffset = WORKLOAD_NO_STRING;
+        if (length > 0) {
+            extraOffset = addString(parts[STRING_TABLE], &stringsSize, extra);
+            hasExtraColumns = 1;
+        }
+        if (nameOffset == WORKLOAD_NO_STRING || (length > 0 && extraOffset == WORKLOAD_NO_STRING) || count == INT_MAX) {
+            fprintf(stderr, "Workload too large for the binary format\n");
+            return 1;
+        }
+        int32_t values[3] = {arrival, service, memory};
+        fwrite(&values[0], sizeof(int32_t), 1, parts[ARRIVAL_COLUMN]);
+        fwrite(&values[1], sizeof(int32_t), 1, parts[SERVICE_COLUMN]);
+        fwrite(&values[2], sizeof(int32_t), 1, parts[MEMORY_COLUMN]);
+        fwrite(&nameOffset, sizeof(nameOffset), 1, parts[NAME_COLUMN]);
+        fwrite(&extraOffset, sizeof(extraOffset), 1, parts[EXTRA_COLUMN]);
+        count++;
+    }
+    if (ferror(input)) {
+        fprintf(stderr, "Failed to read %s\n", argv[1]);
+        return 1;
+    }
+    fclose(input);
+
+    // Every column holds 4-byte values, so each one stays aligned after the header
+    WorkloadHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.byteOrder = WORKLOAD_BYTE_ORDER;
+    header.count = count;
+    uint64_t offset = sizeof(header);
+    header.arrivalOffset = offset;
+    header.serviceOffset = offset += count * 4;
+    header.memoryOffset = offset += count * 4;
+    header.nameOffset = offset += count * 4;
+    offset += count * 4;
+    if (hasExtraColumns) {
+        header.extraColumnsOffset = offset;
+        offset += count * 4;
+    }
+    header.stringsOffset = offset;
+    header.stringsSize = stringsSize;
+
+    FILE *output = fopen(argv[2], "wb");
+    if (!output) {
+        fprintf(stderr, "Failed to create %s\n", argv[2]);
+        return 1;
+    }
+    int failed = fwrite(&header, sizeof(header), 1, output) != 1;
+    for (int i = 0; i < OUTPUT_PARTS && !failed; i++) {
+        if (i != EXTRA_COLUMN || hasExtraColumns) {
+            failed = copyPart(parts[i], output) != 0;
+        }
+        fclose(parts[i]);
+    }
+    failed |= fclose(output) != 0;
+    if (failed) {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
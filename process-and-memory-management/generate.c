@@ -0,0 +1,190 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Synthetic workload generator. Writes processes in the allocate input format,
+// "arrival name service memory", one per line and in arrival order. The same seed and
+// options always give the same file
+
+// Largest count whose names still fit the 8 characters of a process name
+#define MAX_PROCESSES 10000000
+
+typedef enum {
+    ARRIVALS_POISSON, // Exponential gaps at a constant rate
+    ARRIVALS_BURSTY   // Bursts at burstFactor times the rate separated by idle gaps
+} ArrivalPattern;
+
+typedef enum {
+    MEMORY_UNIFORM,     // Uniform between the minimum and the maximum
+    MEMORY_EXPONENTIAL, // Exponential around the mean, clamped to the range
+    MEMORY_BIMODAL      // Mostly small processes near the minimum, largePercent near the maximum
+} MemoryDistribution;
+
+typedef struct {
+    long count; // Processes to generate
+    unsigned long long seed; // Seed of the random number generator
+    ArrivalPattern arrivals; // Arrival process
+    double rate; // Mean arrivals per unit of time
+    double burstLength; // Mean arrivals per burst
+    double burstFactor; // Arrival rate within a burst relative to the mean rate
+    double serviceAlpha; // Pareto shape of service times, smaller is heavier tailed
+    int serviceMin; // Shortest service time
+    int serviceMax; // Longest service time, the tail is cut here
+    MemoryDistribution memory; // Memory size distribution
+    int memoryMin; // Smallest memory requirement in KB
+    int memoryMax; // Largest memory requirement in KB
+    int memoryMean; // Mean of the exponential distribution in KB
+    int largePercent; // Percent of large processes in the bimodal distribution
+} GeneratorOptions;
+
+int parseGeneratorArguments(int argc, char *argv[], GeneratorOptions *options);
+
+// splitmix64, small and the same on every platform unlike rand()
+static unsigned long long nextRandom(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in (0, 1), never 0 so it can go through log and pow
+static double uniform(unsigned long long *state) {
+    return ((nextRandom(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double exponential(unsigned long long *state, double mean) {
+    return -mean * log(uniform(state));
+}
+
+static int serviceTime(unsigned long long *state, GeneratorOptions *options) {
+    double service = options->serviceMin * pow(uniform(state), -1.0 / options->serviceAlpha);
+    return service < options->serviceMax ? (int)service : options->serviceMax;
+}
+
+static int memorySize(unsigned long long *state, GeneratorOptions *options) {
+    int range = options->memoryMax - options->memoryMin + 1;
+    double size;
+    if (options->memory == MEMORY_EXPONENTIAL) {
+        size = options->memoryMin + exponential(state, options->memoryMean - options->memoryMin);
+    } else if (options->memory == MEMORY_BIMODAL) {
+        // Each mode covers a tenth of the range at its end
+        int spread = range / 10 > 0 ? range / 10 : 1;
+        int large = (int)(nextRandom(state) % 100) < options->largePercent;
+        size = large ? options->memoryMax - (double)(nextRandom(state) % spread)
+                     : options->memoryMin + (double)(nextRandom(state) % spread);
+    } else {
+        size = options->memoryMin + (double)(nextRandom(state) % range);
+    }
+    return size < options->memoryMax ? (int)size : options->memoryMax;
+}
+
+int main(int argc, char *argv[]) {
+    GeneratorOptions options = {
+        .count = 1000,
+        .seed = 1,
+        .arrivals = ARRIVALS_POISSON,
+        .rate = 0.1,
+        .burstLength = 20,
+        .burstFactor = 10,
+        .serviceAlpha = 1.5,
+        .serviceMin = 2,
+        .serviceMax = 1000,
+        .memory = MEMORY_UNIFORM,
+        .memoryMin = 16,
+        .memoryMax = 512,
+        .memoryMean = 128,
+        .largePercent = 10,
+    };
+    if (parseGeneratorArguments(argc, argv, &options) != 0) {
+        fprintf(stderr, "Usage: %s [-n count] [-s seed] [--arrivals poisson|bursty] [--rate r] "
+                        "[--burst-length n] [--burst-factor f] [--service-alpha a] [--service-min t] "
+                        "[--service-max t] [--memory uniform|exponential|bimodal] [--memory-min KB] "
+                        "[--memory-max KB] [--memory-mean KB] [--large-percent p]\n", argv[0]);
+        return 1;
+    }
+
+    static char buffer[1 << 16];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+    unsigned long long state = options.seed;
+    double clock = 0.0;
+    // Gap between two arrivals inside a burst, and the idle gap that keeps the long run rate
+    double burstGap = 1.0 / (options.rate * options.burstFactor);
+    double idleGap = options.burstLength / options.rate * (1.0 - 1.0 / options.burstFactor);
+    for (long i = 0; i < options.count; i++) {
+        if (options.arrivals == ARRIVALS_BURSTY) {
+            clock += exponential(&state, burstGap);
+            if (uniform(&state) < 1.0 / options.burstLength) {
+                clock += exponential(&state, idleGap);
+            }
+        } else if (i > 0) {
+            clock += exponential(&state, 1.0 / options.rate);
+        }
+        if (printf("%ld P%ld %d %d\n", (long)clock, i, serviceTime(&state, &options), memorySize(&state, &options)) < 0) {
+            fprintf(stderr, "Failed to write the workload\n");
+            return 1;
+        }
+    }
+    return fflush(stdout) == 0 ? 0 : 1;
+}
+
+int parseGeneratorArguments(int argc, char *argv[], GeneratorOptions *options) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return -1;
+        }
+        if (strcmp(argv[i], "-n") == 0) {
+            options->count = atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            options->seed = strtoull(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--arrivals") == 0) {
+            if (strcmp(argv[i + 1], "poisson") == 0) {
+                options->arrivals = ARRIVALS_POISSON;
+            } else if (strcmp(argv[i + 1], "bursty") == 0) {
+                options->arrivals = ARRIVALS_BURSTY;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--rate") == 0) {
+            options->rate = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--burst-length") == 0) {
+            options->burstLength = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--burst-factor") == 0) {
+            options->burstFactor = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--service-alpha") == 0) {
+            options->serviceAlpha = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--service-min") == 0) {
+            options->serviceMin = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--service-max") == 0) {
+            options->serviceMax = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            if (strcmp(argv[i + 1], "uniform") == 0) {
+                options->memory = MEMORY_UNIFORM;
+            } else if (strcmp(argv[i + 1], "exponential") == 0) {
+                options->memory = MEMORY_EXPONENTIAL;
+            } else if (strcmp(argv[i + 1], "bimodal") == 0) {
+                options->memory = MEMORY_BIMODAL;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--memory-min") == 0) {
+            options->memoryMin = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--memory-max") == 0) {
+            options->memoryMax = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--memory-mean") == 0) {
+            options->memoryMean = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--large-percent") == 0) {
+            options->largePercent = atoi(argv[i + 1]);
+        } else {
+            return -1;
+        }
+    }
+    if (options->count < 1 || options->count > MAX_PROCESSES || options->rate <= 0 || options->burstLength < 1 ||
+        options->burstFactor < 1 || options->serviceAlpha <= 0 || options->serviceMin < 1 ||
+        options->serviceMax < options->serviceMin || options->memoryMin < 0 || options->memoryMax < options->memoryMin ||
+        options->memoryMean < options->memoryMin) {
+        return -1;
+    }
+    return 0;
+}
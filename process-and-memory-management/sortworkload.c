@@ -0,0 +1,468 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sorts workloads in the allocate text format by arrival time, for traces that are out
+// of order or merged from several sources. The sort is stable: processes that arrive at
+// the same time keep the order of the input files and of the lines within them. Lines are
+// copied unchanged, lines allocate would skip are dropped.
+//
+// The input is cut into chunks that fit the memory budget. Threads sort the chunks
+// into runs in parallel and spill them to temporary files. Runs are merged k ways as
+// soon as k of the same length are open, so the open files stay few however long the
+// input is, and the runs left at the end are merged into the output
+
+// Runs merged by one pass
+#define MERGE_FAN_IN 64
+
+typedef struct {
+    long memoryKB; // Memory for chunks being read and sorted at once
+    int threads; // Chunks sorted in parallel
+    const char *output; // Output file, NULL for standard output
+} SortOptions;
+
+// A line of a chunk
+typedef struct {
+    int arrival; // Arrival time, the sort key
+    size_t offset; // Start in the chunk text, which follows input order and breaks ties
+} SortLine;
+
+// Lines read together and sorted into one run
+typedef struct {
+    char *text; // Lines, each ending in a newline
+    size_t size; // Bytes of text used
+    size_t capacity; // Bytes of text allocated
+    SortLine *lines; // Lines in input order, sorted in place
+    long count; // Number of lines
+    long lineCapacity; // Lines allocated
+    FILE *run; // Temporary file the sorted run went to
+    pthread_t thread; // Thread sorting it
+    int error; // errno of a failed spill, 0 once it succeeded
+} Chunk;
+
+// Sorted runs spilled so far, in input order
+typedef struct {
+    FILE **files; // Open runs, longest first
+    int count; // Number of open runs
+    int capacity; // Runs allocated
+    long spilled; // Chunks spilled, its digits in base MERGE_FAN_IN count the open runs of each length
+} RunList;
+
+// A run being merged, and its next line
+typedef struct {
+    FILE *file; // Sorted run
+    int index; // Position among the runs merged, earlier runs hold earlier input
+    char *line; // Next line, NULL once the run is exhausted
+    size_t lineSize; // Bytes allocated for line
+    int arrival; // Arrival of the next line
+} RunCursor;
+
+int parseSortArguments(int argc, char *argv[], SortOptions *options, int *firstInput);
+
+// Arrival time of a line allocate would read, -1 if it would skip it
+static int parseArrival(const char *line, int *arrival) {
+    char name[9];
+    int service, memory;
+    return sscanf(line, "%d %8s %d %d", arrival, name, &service, &memory) == 4 ? 0 : -1;
+}
+
+static int compareLines(const void *a, const void *b) {
+    const SortLine *first = (const SortLine *)a;
+    const SortLine *second = (const SortLine *)b;
+    if (first->arrival != second->arrival) {
+        return first->arrival < second->arrival ? -1 : 1;
+    }
+    return first->offset < second->offset ? -1 : first->offset > second->offset;
+}
+
+static int writeLine(FILE *file, const char *line) {
+    return fputs(line, file) < 0 ? -1 : 0;
+}
+
+// Append a line, with a newline even if it was the last line of a file without one.
+// Return -1 when out of memory
+static int addLine(Chunk *chunk, const char *line, size_t length, int arrival) {
+    int newline = length == 0 || line[length - 1] != '\n';
+    if (chunk->size + length + newline + 1 > chunk->capacity) {
+        size_t capacity = chunk->capacity ? 2 * chunk->capacity : 1 << 16;
+        while (chunk->size + length + newline + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *grown = (char *)realloc(chunk->text, capacity);
+        if (!grown) {
+            return -1;
+        }
+        chunk->text = grown;
+        chunk->capacity = capacity;
+    }
+    if (chunk->count == chunk->lineCapacity) {
+        long lineCapacity = chunk->lineCapacity ? 2 * chunk->lineCapacity : 1024;
+        SortLine *grown = (SortLine *)realloc(chunk->lines, lineCapacity * sizeof(SortLine));
+        if (!grown) {
+            return -1;
+        }
+        chunk->lines = grown;
+        chunk->lineCapacity = lineCapacity;
+    }
+    chunk->lines[chunk->count].arrival = arrival;
+    chunk->lines[chunk->count].offset = chunk->size;
+    chunk->count++;
+    memcpy(chunk->text + chunk->size, line, length);
+    chunk->size += length;
+    if (newline) {
+        chunk->text[chunk->size++] = '\n';
+    }
+    chunk->text[chunk->size++] = '\0';
+    return 0;
+}
+
+// Bytes a chunk holds, text and line table, to compare with the budget
+static size_t chunkBytes(Chunk *chunk) {
+    return chunk->size + chunk->count * sizeof(SortLine);
+}
+
+static void freeChunk(Chunk *chunk) {
+    free(chunk->text);
+    free(chunk->lines);
+    free(chunk);
+}
+
+// Sort a chunk and spill it as a run. The text is freed once written
+static void* sortChunk(void *argument) {
+    Chunk *chunk = (Chunk *)argument;
+    qsort(chunk->lines, chunk->count, sizeof(SortLine), compareLines);
+    chunk->run = tmpfile();
+    int failed = !chunk->run;
+    for (long i = 0; i < chunk->count && !failed; i++) {
+        failed = writeLine(chunk->run, chunk->text + chunk->lines[i].offset) != 0;
+    }
+    if (!failed && fflush(chunk->run) != 0) {
+        failed = 1;
+    }
+    chunk->error = failed ? (errno ? errno : EIO) : 0;
+    free(chunk->text);
+    free(chunk->lines);
+    chunk->text = NULL;
+    chunk->lines = NULL;
+    return NULL;
+}
+
+// Read the next line of a run into its cursor
+static int advanceCursor(RunCursor *cursor) {
+    if (getline(&cursor->line, &cursor->lineSize, cursor->file) < 0) {
+        free(cursor->line);
+        cursor->line = NULL;
+        return ferror(cursor->file) ? -1 : 0;
+    }
+    return parseArrival(cursor->line, &cursor->arrival);
+}
+
+static int cursorBefore(RunCursor *a, RunCursor *b) {
+    if (a->arrival != b->arrival) {
+        return a->arrival < b->arrival;
+    }
+    return a->index < b->index;
+}
+
+static void siftDown(RunCursor **heap, int count, int i) {
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < count && cursorBefore(heap[left], heap[smallest])) {
+            smallest = left;
+        }
+        if (right < count && cursorBefore(heap[right], heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        RunCursor *swap = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+// Merge count runs into output, earliest arrival first and earlier runs first on ties.
+// The runs are closed, which deletes them. Return 0 on success, -1 with errno set
+static int mergeRuns(FILE **runs, int count, FILE *output) {
+    RunCursor *cursors = (RunCursor *)calloc(count, sizeof(RunCursor));
+    RunCursor **heap = (RunCursor **)malloc(count * sizeof(RunCursor *));
+    int failed = !cursors || !heap;
+    int heapCount = 0;
+    for (int i = 0; i < count && !failed; i++) {
+        cursors[i].file = runs[i];
+        cursors[i].index = i;
+        rewind(runs[i]);
+        failed = advanceCursor(&cursors[i]) != 0;
+        if (cursors[i].line) {
+            heap[heapCount++] = &cursors[i];
+        }
+    }
+    for (int i = heapCount / 2 - 1; i >= 0 && !failed; i--) {
+        siftDown(heap, heapCount, i);
+    }
+
+    while (heapCount > 0 && !failed) {
+        RunCursor *next = heap[0];
+        failed = writeLine(output, next->line) != 0 || advanceCursor(next) != 0;
+        if (!next->line) {
+            heap[0] = heap[--heapCount];
+        }
+        siftDown(heap, heapCount, 0);
+    }
+
+    // Closing the runs must not hide why the merge failed
+    int error = errno;
+    for (int i = 0; i < count; i++) {
+        if (cursors) {
+            free(cursors[i].line);
+        }
+        fclose(runs[i]);
+    }
+    free(cursors);
+    free(heap);
+    errno = error;
+    return failed ? -1 : 0;
+}
+
+// Merge the last count runs into one run in their place. Return 0 on success, -1 with
+// errno set
+static int mergeTail(RunList *runs, int count) {
+    FILE *run = tmpfile();
+    if (!run) {
+        // Runs not merged yet are left for the exit to delete
+        return -1;
+    }
+    int first = runs->count - count;
+    runs->count = first;
+    if (mergeRuns(runs->files + first, count, run) != 0 || fflush(run) != 0) {
+        int error = errno;
+        fclose(run);
+        errno = error;
+        return -1;
+    }
+    runs->files[runs->count++] = run;
+    return 0;
+}
+
+// Merge the runs into output, the shortest ones first until one pass can take them all.
+// Return 0 on success, -1 with errno set
+static int mergeAll(RunList *runs, FILE *output) {
+    while (runs->count > MERGE_FAN_IN) {
+        if (mergeTail(runs, MERGE_FAN_IN) != 0) {
+            return -1;
+        }
+    }
+    int count = runs->count;
+    runs->count = 0;
+    return mergeRuns(runs->files, count, output);
+}
+
+// Wait for a chunk to be spilled and add its run to runs, merging the newest runs each
+// time MERGE_FAN_IN of one length are open. Return 0 on success, -1 after reporting why
+static int finishChunk(Chunk *chunk, RunList *runs) {
+    pthread_join(chunk->thread, NULL);
+    int failed = chunk->error != 0;
+    if (failed) {
+        fprintf(stderr, "Failed to spill a sorted run: %s\n", strerror(chunk->error));
+        // A run cut short still holds its file open
+        if (chunk->run) {
+            fclose(chunk->run);
+        }
+    }
+    if (!failed && runs->count == runs->capacity) {
+        int capacity = runs->capacity ? 2 * runs->capacity : MERGE_FAN_IN;
+        FILE **grown = (FILE **)realloc(runs->files, capacity * sizeof(FILE *));
+        if (grown) {
+            runs->files = grown;
+            runs->capacity = capacity;
+        } else {
+            perror("Failed to track the sorted runs");
+            failed = 1;
+        }
+    }
+    if (!failed) {
+        runs->files[runs->count++] = chunk->run;
+        runs->spilled++;
+        // Every MERGE_FAN_IN runs of one length become one of the next length up
+        for (long length = MERGE_FAN_IN; !failed && runs->spilled % length == 0; length *= MERGE_FAN_IN) {
+            if (mergeTail(runs, MERGE_FAN_IN) != 0) {
+                perror("Failed to merge sorted runs");
+                failed = 1;
+            }
+        }
+    }
+    freeChunk(chunk);
+    return failed ? -1 : 0;
+}
+
+// Start a thread sorting and spilling chunk. Return 0 on success, -1 after reporting why
+static int startChunk(Chunk *chunk) {
+    int error = pthread_create(&chunk->thread, NULL, sortChunk, chunk);
+    if (error != 0) {
+        fprintf(stderr, "Failed to start a sorting thread: %s\n", strerror(error));
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    SortOptions options = {
+        .memoryKB = 256 * 1024,
+        .threads = 4,
+        .output = NULL,
+    };
+    int firstInput;
+    if (parseSortArguments(argc, argv, &options, &firstInput) != 0) {
+        fprintf(stderr, "Usage: %s [-m memory KB] [-j threads] [-o output] input...\n", argv[0]);
+        return 1;
+    }
+    // Every thread holds a chunk while it sorts, and the reader fills one more
+    size_t chunkLimit = (size_t)options.memoryKB * 1024 / (options.threads + 1);
+
+    // One slot more than threads for the last chunk, which starts while the others finish
+    Chunk **inFlight = (Chunk **)calloc(options.threads + 1, sizeof(Chunk *));
+    RunList runs = {0};
+    int pending = 0; // Chunks being sorted, oldest at inFlight[0]
+    Chunk *chunk = NULL;
+    long skipped = 0;
+    int failed = !inFlight;
+    char *line = NULL;
+    size_t lineSize = 0;
+
+    for (int i = firstInput; i < argc && !failed; i++) {
+        FILE *input = fopen(argv[i], "r");
+        if (!input) {
+            perror(argv[i]);
+            failed = 1;
+            break;
+        }
+        ssize_t length;
+        while (!failed && (length = getline(&line, &lineSize, input)) >= 0) {
+            int arrival;
+            if (parseArrival(line, &arrival) != 0) {
+                skipped++;
+                continue;
+            }
+            if ((!chunk && !(chunk = (Chunk *)calloc(1, sizeof(Chunk)))) || addLine(chunk, line, length, arrival) != 0) {
+                perror("Failed to read a chunk");
+                failed = 1;
+                break;
+            }
+            if (chunkBytes(chunk) < chunkLimit) {
+                continue;
+            }
+            // Chunk full: wait for the oldest one when every thread is busy, runs stay in input order
+            if (pending == options.threads) {
+                failed = finishChunk(inFlight[0], &runs) != 0;
+                memmove(inFlight, inFlight + 1, (options.threads - 1) * sizeof(Chunk *));
+                pending--;
+            }
+            if (!failed) {
+                failed = startChunk(chunk) != 0;
+            }
+            if (!failed) {
+                inFlight[pending++] = chunk;
+                chunk = NULL;
+            }
+        }
+        if (!failed && ferror(input)) {
+            perror(argv[i]);
+            failed = 1;
+        }
+        fclose(input);
+    }
+    free(line);
+
+    FILE *output = NULL;
+    if (!failed) {
+        output = options.output ? fopen(options.output, "w") : stdout;
+        if (!output) {
+            perror(options.output);
+            failed = 1;
+        }
+    }
+    if (!failed && runs.count == 0 && pending == 0) {
+        // Everything fit in one chunk, sort it in memory
+        if (chunk) {
+            qsort(chunk->lines, chunk->count, sizeof(SortLine), compareLines);
+            for (long i = 0; i < chunk->count && !failed; i++) {
+                failed = writeLine(output, chunk->text + chunk->lines[i].offset) != 0;
+            }
+            if (failed) {
+                perror("Failed to write the sorted workload");
+            }
+        }
+    } else if (!failed) {
+        if (chunk) {
+            failed = startChunk(chunk) != 0;
+            if (!failed) {
+                inFlight[pending++] = chunk;
+                chunk = NULL;
+            }
+        }
+        for (int i = 0; i < pending; i++) {
+            failed |= finishChunk(inFlight[i], &runs) != 0;
+        }
+        pending = 0;
+        if (!failed && mergeAll(&runs, output) != 0) {
+            perror("Failed to merge sorted runs");
+            failed = 1;
+        }
+    }
+    for (int i = 0; i < pending; i++) {
+        finishChunk(inFlight[i], &runs);
+    }
+    if (chunk) {
+        freeChunk(chunk);
+    }
+    if (output) {
+        int written = fflush(output) == 0;
+        if (output != stdout) {
+            written &= fclose(output) == 0;
+        }
+        if (!written) {
+            perror("Failed to write the sorted workload");
+            failed = 1;
+        }
+    }
+    free(inFlight);
+    free(runs.files);
+
+    if (skipped > 0) {
+        fprintf(stderr, "Skipped %ld lines that are not processes\n", skipped);
+    }
+    if (failed) {
+        fprintf(stderr, "Failed to sort the workload\n");
+        return 1;
+    }
+    return 0;
+}
+
+int parseSortArguments(int argc, char *argv[], SortOptions *options, int *firstInput) {
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i += 2) {
+        if (i + 1 >= argc) {
+            return -1;
+        }
+        if (strcmp(argv[i], "-m") == 0) {
+            options->memoryKB = atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "-j") == 0) {
+            options->threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            options->output = argv[i + 1];
+        } else {
+            return -1;
+        }
+    }
+    *firstInput = i;
+    if (i == argc || options->memoryKB < 1 || options->threads < 1) {
+        return -1;
+    }
+    return 0;
+}